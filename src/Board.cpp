@@ -2,8 +2,10 @@
 #define BOARD_CPP // GUARD
 
 #include "Board.hpp"
+#include "Evaluation.hpp"
 #include "Move.hpp"
 #include "globals.hpp"
+#include <algorithm>
 #include <assert.h>
 #include <bit>
 #include <bitset>
@@ -17,8 +19,8 @@ Board::Board() {
   piece_bitboards[1].fill(0);
   all_piece_bitboards.fill(0);
   turn_color = WHITE;
-  initialize_lookups();
-  init_zobrist_keys();
+  static const bool lookups_initialized = initialize_lookups();
+  (void)lookups_initialized;
   castle_rights = 0xF;
   castle_rights_size = 0;
   for (int i = 0; i < 64; i++) {
@@ -30,7 +32,11 @@ Board::Board() {
   captured_pieces_size[1] = 0;
   half_moves = 0;
   full_moves = 1;
+  history_size = 0;
   zkey = generate_zkey();
+  pawn_zkey = generate_pawn_zkey();
+  psq_score = generate_psq_score();
+  phase = generate_phase();
 }
 
 void Board::clear() {
@@ -50,7 +56,11 @@ void Board::clear() {
   captured_pieces_size[1] = 0;
   half_moves = 0;
   full_moves = 1;
+  history_size = 0;
   zkey = generate_zkey();
+  pawn_zkey = generate_pawn_zkey();
+  psq_score = generate_psq_score();
+  phase = generate_phase();
 }
 
 // Initializer:
@@ -107,6 +117,9 @@ void Board::initialize_board_starting_position() {
   board_pieces[63] = ROOK;
 
   zkey = generate_zkey();
+  pawn_zkey = generate_pawn_zkey();
+  psq_score = generate_psq_score();
+  phase = generate_phase();
 };
 
 void Board::initialize_perft_position_2() {
@@ -145,6 +158,9 @@ void Board::initialize_perft_position_2() {
   }
 
   zkey = generate_zkey();
+  pawn_zkey = generate_pawn_zkey();
+  psq_score = generate_psq_score();
+  phase = generate_phase();
 }
 
 void Board::initialize_perft_position_3() {
@@ -177,6 +193,9 @@ void Board::initialize_perft_position_3() {
   }
 
   zkey = generate_zkey();
+  pawn_zkey = generate_pawn_zkey();
+  psq_score = generate_psq_score();
+  phase = generate_phase();
 }
 
 bool Board::initialize_fen(std::string fen) {
@@ -223,7 +242,7 @@ bool Board::initialize_fen(std::string fen) {
       set_queen_castle_right(WHITE);
     } else if (castle_str[i] == 'k') {
       set_king_castle_right(BLACK);
-    } else {
+    } else if (castle_str[i] == 'q') {
       set_queen_castle_right(BLACK);
     }
   }
@@ -239,10 +258,10 @@ bool Board::initialize_fen(std::string fen) {
     bitboard below = south(ep_square);
     if (move_color == WHITE) {
       Move move(below, above, 1);
-      moves[move_color][moves_size[move_color]++] = move;
+      moves[move_color][moves_size[move_color]++ & (MAX_MOVES - 1)] = move;
     } else {
       Move move(above, below, 1);
-      moves[move_color][moves_size[move_color]++] = move;
+      moves[move_color][moves_size[move_color]++ & (MAX_MOVES - 1)] = move;
     }
   }
 
@@ -251,6 +270,9 @@ bool Board::initialize_fen(std::string fen) {
   fen_ss >> full_moves;
 
   zkey = generate_zkey();
+  pawn_zkey = generate_pawn_zkey();
+  psq_score = generate_psq_score();
+  phase = generate_phase();
 
   return true;
 }
@@ -295,7 +317,7 @@ Piece Board::get_piece_at_position(bitboard position, Color color) {
 }
 
 Move Board::get_last_move(Color color) {
-  return moves[color][moves_size[color] - 1];
+  return moves[color][(moves_size[color] - 1) & (MAX_MOVES - 1)];
 }
 
 bool Board::is_moves_empty(Color color) { return moves_size[color] == 0; }
@@ -314,19 +336,21 @@ std::array<std::array<bitboard, 7>, 2> &Board::get_piece_bitboards() {
   return piece_bitboards;
 }
 
-int Board::get_square_index(bitboard square) {
-  return square_index_lookup[square];
-}
-
-bitboard Board::get_square(int square_index) {
-  return square_lookup[square_index];
-}
-
 // Setters:
 void Board::set_piece_positions(Piece piece, Color color,
                                 bitboard new_positions) {
   all_piece_bitboards[piece] &= ~piece_bitboards[color][piece];
   piece_bitboards[color][ALL] &= ~piece_bitboards[color][piece];
+  for (bitboard old_positions = piece_bitboards[color][piece]; old_positions;
+       pop_lsb(old_positions)) {
+    psq_score -= piece_square_scores[color][piece][lsb(old_positions)];
+    if (piece == PAWN) {
+      pawn_zkey ^= piece_square_zkeys[color][PAWN][lsb(old_positions)];
+    }
+  }
+  phase += Evaluation::phase_weights[piece] *
+           ((int)popcount(new_positions) -
+            (int)popcount(piece_bitboards[color][piece]));
   piece_bitboards[color][piece] = new_positions;
   all_piece_bitboards[piece] |= new_positions;
   piece_bitboards[color][ALL] |= new_positions;
@@ -334,6 +358,10 @@ void Board::set_piece_positions(Piece piece, Color color,
   while (new_positions) {
     board_pieces[lsb(new_positions)] = piece;
     zkey ^= piece_square_zkeys[color][piece][lsb(new_positions)];
+    psq_score += piece_square_scores[color][piece][lsb(new_positions)];
+    if (piece == PAWN) {
+      pawn_zkey ^= piece_square_zkeys[color][PAWN][lsb(new_positions)];
+    }
     pop_lsb(new_positions);
   }
 }
@@ -355,6 +383,40 @@ bool Board::is_move_legal(Move &move, Color color) {
   return is_legal;
 }
 
+bitboard Board::get_checkers(Color color) {
+  return get_attacks_to_king(get_piece_positions(KING, color), color);
+}
+
+/*
+ * Pieces of the given color that are the only piece between their king and an
+ * enemy slider. Such pieces may only move along the line through the king.
+ */
+bitboard Board::get_pinned_pieces(Color color) {
+  Color op_color = negate_color(color);
+  bitboard king_position = get_piece_positions(KING, color);
+  bitboard occupancy =
+      get_all_piece_positions(WHITE) | get_all_piece_positions(BLACK);
+  bitboard op_pieces = get_all_piece_positions(op_color);
+
+  // enemy sliders that would attack the king if our pieces were removed
+  bitboard snipers = (get_rook_attacks(king_position, op_pieces) &
+                      (get_piece_positions(ROOK, op_color) |
+                       get_piece_positions(QUEEN, op_color))) |
+                     (get_bishop_attacks(king_position, op_pieces) &
+                      (get_piece_positions(BISHOP, op_color) |
+                       get_piece_positions(QUEEN, op_color)));
+
+  bitboard pinned = 0;
+  while (snipers) {
+    bitboard sniper = pop_lsb(snipers);
+    bitboard blockers = get_squares_between(king_position, sniper) & occupancy;
+    if (blockers && !(blockers & (blockers - 1))) {
+      pinned |= blockers & get_all_piece_positions(color);
+    }
+  }
+  return pinned;
+}
+
 // Attacks:
 bool Board::is_position_attacked_by(bitboard position, Color color) {
   std::array<Piece, 6> piece_array = {PAWN, KNIGHT, BISHOP, ROOK, QUEEN, KING};
@@ -392,6 +454,40 @@ bitboard Board::get_piece_attacks(Piece piece, bitboard position, Color color) {
   return 0;
 }
 
+/*
+ * Pieces of the given color attacking position, with sliding attacks computed
+ * against the given occupancy instead of the current one.
+ */
+bitboard Board::get_attackers(bitboard position, Color color,
+                              bitboard occupancy) {
+  return (get_pawn_attacks(position, negate_color(color)) &
+          get_piece_positions(PAWN, color)) |
+         (get_knight_attacks(position) & get_piece_positions(KNIGHT, color)) |
+         (get_bishop_attacks(position, occupancy) &
+          (get_piece_positions(BISHOP, color) |
+           get_piece_positions(QUEEN, color))) |
+         (get_rook_attacks(position, occupancy) &
+          (get_piece_positions(ROOK, color) |
+           get_piece_positions(QUEEN, color))) |
+         (get_king_attacks(position) & get_piece_positions(KING, color));
+}
+
+bitboard Board::get_bishop_attacks(bitboard position, bitboard occupancy) {
+  int square_index = lsb(position);
+  uint64_t key = ((occupancy & BISHOP_MASKS[square_index]) *
+                  BISHOP_MAGICS[square_index]) >>
+                 BISHOP_SHIFTS[square_index];
+  return bishop_attacks_magic_bb[square_index][key];
+}
+
+bitboard Board::get_rook_attacks(bitboard position, bitboard occupancy) {
+  int square_index = lsb(position);
+  uint64_t key =
+      ((occupancy & ROOK_MASKS[square_index]) * ROOK_MAGICS[square_index]) >>
+      ROOK_SHIFTS[square_index];
+  return rook_attacks_magic_bb[square_index][key];
+}
+
 bitboard Board::get_pawn_single_push(bitboard position, Color color) {
   return pawn_single_pushes_lookups[color][lsb(position)];
 }
@@ -405,6 +501,198 @@ bitboard Board::get_blockers(bitboard position) {
          ~position;
 }
 
+/*
+ * Looks for an earlier position that the side to move could reach again
+ * with a single reversible move. The key of the current position xor that of
+ * a position an odd number of plies back is looked up in the cuckoo tables;
+ * a hit is the difference of one move, which is playable if the squares
+ * between its origin and destination are empty.
+ * http://web.archive.org/web/20201107002606/https://marcelk.net/2013-04-06/paper/upcoming-rep-v2.pdf
+ */
+bool Board::has_upcoming_repetition(unsigned ply) {
+  size_t distance =
+      std::min(std::min((size_t)half_moves, history_size), MAX_HISTORY - 1);
+  bitboard occupancy =
+      get_all_piece_positions(WHITE) | get_all_piece_positions(BLACK);
+  for (size_t i = 3; i <= distance && i < ply; i += 2) {
+    uint64_t move_key =
+        zkey ^ zkey_history[(history_size - i) & (MAX_HISTORY - 1)];
+    int index = cuckoo_hash_one(move_key);
+    if (cuckoo_zkeys[index] != move_key) {
+      index = cuckoo_hash_two(move_key);
+      if (cuckoo_zkeys[index] != move_key) {
+        continue;
+      }
+    }
+    Move move(cuckoo_moves[index]);
+    if (!(get_squares_between(move.get_origin(), move.get_destination()) &
+          occupancy)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Static Exchange Evaluation:
+// https://www.chessprogramming.org/SEE_-_The_Swap_Algorithm
+int Board::see(Move move) {
+  bitboard destination = move.get_destination();
+  bitboard from = move.get_origin();
+  bitboard occupancy =
+      get_all_piece_positions(WHITE) | get_all_piece_positions(BLACK);
+  if (move.get_flags() == 5) {
+    occupancy ^= turn_color == WHITE ? south(destination) : north(destination);
+  }
+  bitboard diagonal_sliders =
+      all_piece_bitboards[BISHOP] | all_piece_bitboards[QUEEN];
+  bitboard straight_sliders =
+      all_piece_bitboards[ROOK] | all_piece_bitboards[QUEEN];
+  bitboard attackers = get_attackers(destination, WHITE, occupancy) |
+                       get_attackers(destination, BLACK, occupancy);
+
+  // gain[d] is the material won by the side making the d-th capture if the
+  // piece it captured with is taken in turn
+  int gain[32];
+  int d = 0;
+  gain[0] = get_see_gain(move);
+  Piece attacker = get_see_attacker(move);
+  Color color = turn_color;
+  do {
+    ++d;
+    gain[d] = Evaluation::piece_values[attacker] - gain[d - 1];
+    if (std::max(-gain[d - 1], gain[d]) < 0) {
+      break; // neither side can improve by continuing
+    }
+    occupancy ^= from;
+    // sliders behind the piece that just captured now see the square
+    attackers |=
+        (get_bishop_attacks(destination, occupancy) & diagonal_sliders) |
+        (get_rook_attacks(destination, occupancy) & straight_sliders);
+    attackers &= occupancy;
+    color = negate_color(color);
+    from = get_least_valuable_attacker(
+        attackers & get_all_piece_positions(color), attacker);
+  } while (from && d < 31);
+
+  while (--d) {
+    gain[d - 1] = -std::max(-gain[d - 1], gain[d]);
+  }
+  return gain[0];
+}
+
+bool Board::see_ge(Move move, int threshold) {
+  int gain = get_see_gain(move);
+  if (gain < threshold) {
+    return false; // winning the victim for free is not enough
+  }
+  if (gain - Evaluation::piece_values[get_see_attacker(move)] >= threshold) {
+    return true; // still enough after losing the capturing piece
+  }
+  return see(move) >= threshold;
+}
+
+// Draws:
+// A mate delivered on the hundredth half-move still wins.
+bool Board::is_draw() {
+  return (half_moves >= 100 && !is_checkmate()) || is_repetition();
+}
+
+/*
+ * Whether the side to move is in check and has no legal move. In check only
+ * king moves, captures of the checker and blocks can be legal, so just those
+ * are tried.
+ */
+bool Board::is_checkmate() {
+  Color color = turn_color;
+  Color op_color = negate_color(color);
+  bitboard checkers = get_checkers(color);
+  if (!checkers) {
+    return false;
+  }
+  bitboard king_position = get_piece_positions(KING, color);
+  bitboard pawns = get_piece_positions(PAWN, color);
+  bitboard enemies = get_all_piece_positions(op_color);
+  bitboard occupancy = get_all_piece_positions(color) | enemies;
+
+  bitboard king_moves =
+      get_king_attacks(king_position) & ~get_all_piece_positions(color);
+  while (king_moves) {
+    bitboard destination = pop_lsb(king_moves);
+    Move move(king_position, destination, destination & enemies ? 4 : 0);
+    if (is_move_legal(move, color)) {
+      return false;
+    }
+  }
+  if (checkers & (checkers - 1)) {
+    return true; // double check, only the king can move
+  }
+
+  bitboard promotion_rank = color == WHITE ? RANK_8 : RANK_1;
+  bitboard targets =
+      checkers | get_squares_between(king_position, checkers);
+  while (targets) {
+    bitboard target = pop_lsb(targets);
+    bool is_capture = target == checkers;
+    bitboard origins =
+        get_attackers(target, color, occupancy) & ~king_position;
+    if (!is_capture) {
+      // pawns attack the square but only block it by pushing
+      origins &= ~pawns;
+      bitboard behind = color == WHITE ? south(target) : north(target);
+      bitboard start = color == WHITE ? south(behind) : north(behind);
+      if (behind & pawns) {
+        origins |= behind;
+      } else if (!(behind & occupancy) &&
+                 (start & pawns & (color == WHITE ? RANK_2 : RANK_7))) {
+        Move move(start, target, 1);
+        if (is_move_legal(move, color)) {
+          return false;
+        }
+      }
+    }
+    while (origins) {
+      bitboard origin = pop_lsb(origins);
+      char flag = is_capture ? 4 : 0;
+      if ((origin & pawns) && (target & promotion_rank)) {
+        flag = is_capture ? 15 : 11;
+      }
+      Move move(origin, target, flag);
+      if (is_move_legal(move, color)) {
+        return false;
+      }
+    }
+  }
+
+  // a pawn giving check after a double push may be taken en passant
+  if (!is_moves_empty(op_color)) {
+    Move last_move = get_last_move(op_color);
+    if (last_move.get_flags() == 1 && last_move.get_destination() == checkers) {
+      bitboard ep_square = color == WHITE ? north(checkers) : south(checkers);
+      bitboard origins = get_pawn_attacks(ep_square, op_color) & pawns;
+      while (origins) {
+        Move move(pop_lsb(origins), ep_square, 5);
+        if (is_move_legal(move, color)) {
+          return false;
+        }
+      }
+    }
+  }
+  return true;
+}
+
+// Only positions since the last irreversible move can repeat, and of those
+// only every other one has the same side to move.
+bool Board::is_repetition() {
+  size_t distance =
+      std::min(std::min((size_t)half_moves, history_size), MAX_HISTORY - 1);
+  for (size_t i = 4; i <= distance; i += 2) {
+    if (zkey_history[(history_size - i) & (MAX_HISTORY - 1)] == zkey) {
+      return true;
+    }
+  }
+  return false;
+}
+
 // Moves:
 /**
  * Move cases:
@@ -422,6 +710,9 @@ void Board::execute_move(Move &move) {
   bitboard destination = move.get_destination();
 
   Piece moving_piece = get_piece_at_position(origin, turn_color);
+  push_history();
+  half_moves =
+      moving_piece == PAWN || move.is_capture() ? 0 : half_moves + 1;
   update_castle_rights(move, moving_piece);
 
   if (move_flags == 1) {
@@ -470,11 +761,14 @@ void Board::execute_move(Move &move) {
     zkey ^= en_passant_zkeys[file_index];
   }
 
-  moves[turn_color][moves_size[turn_color]++] = move;
+  moves[turn_color][moves_size[turn_color]++ & (MAX_MOVES - 1)] = move;
 
   set_turn_color(negate_color(turn_color));
 
   assert(zkey == generate_zkey());
+  assert(pawn_zkey == generate_pawn_zkey());
+  assert(psq_score == generate_psq_score());
+  assert(phase == generate_phase());
 }
 
 // Opposite of execute_move
@@ -533,7 +827,58 @@ void Board::undo_move(Move &move) {
     zkey ^= en_passant_zkeys[file_index];
   }
 
+  half_moves = half_moves_history[--history_size & (MAX_HISTORY - 1)];
+  assert(zkey == generate_zkey());
+  assert(pawn_zkey == generate_pawn_zkey());
+  assert(psq_score == generate_psq_score());
+  assert(phase == generate_phase());
+}
+
+void Board::make_null_move() {
+  if (!is_moves_empty(negate_color(turn_color))) {
+    Move last_move = get_last_move(negate_color(turn_color));
+    if (last_move.get_flags() == 1) {
+      int file_index = 7 - (lsb(last_move.get_origin()) % 8);
+      zkey ^= en_passant_zkeys[file_index];
+    }
+  }
+
+  moves[turn_color][moves_size[turn_color]++ & (MAX_MOVES - 1)] = Move();
+
+  // positions before a null move were not really played, so the null move
+  // ends the repetition scan as an irreversible move would
+  push_history();
+  half_moves = 0;
+
+  set_turn_color(negate_color(turn_color));
+
   assert(zkey == generate_zkey());
+  assert(pawn_zkey == generate_pawn_zkey());
+  assert(psq_score == generate_psq_score());
+  assert(phase == generate_phase());
+}
+
+// Opposite of make_null_move
+void Board::undo_null_move() {
+  set_turn_color(negate_color(turn_color));
+
+  --moves_size[turn_color];
+  assert(
+      moves[turn_color][moves_size[turn_color] & (MAX_MOVES - 1)].is_null());
+  half_moves = half_moves_history[--history_size & (MAX_HISTORY - 1)];
+
+  if (!is_moves_empty(negate_color(turn_color))) {
+    Move last_move = get_last_move(negate_color(turn_color));
+    if (last_move.get_flags() == 1) {
+      int file_index = 7 - (lsb(last_move.get_origin()) % 8);
+      zkey ^= en_passant_zkeys[file_index];
+    }
+  }
+
+  assert(zkey == generate_zkey());
+  assert(pawn_zkey == generate_pawn_zkey());
+  assert(psq_score == generate_psq_score());
+  assert(phase == generate_phase());
 }
 
 // Print:
@@ -564,6 +909,62 @@ void Board::print() {
 }
 
 // Zobrist Keys:
+uint64_t Board::piece_square_zkeys[2][6][64];
+uint64_t Board::side_zkey;
+uint64_t Board::castling_zkeys[4];
+uint64_t Board::en_passant_zkeys[8];
+uint64_t Board::cuckoo_zkeys[CUCKOO_SIZE];
+uint16_t Board::cuckoo_moves[CUCKOO_SIZE];
+
+/*
+ * Stores the key difference of every reversible move, a piece other than a
+ * pawn moving between two squares of an empty board, with the move. The
+ * table is a cuckoo hash: each key lives at one of its two hash indices.
+ */
+void Board::initialize_cuckoo_tables() {
+  for (int i = 0; i < CUCKOO_SIZE; i++) {
+    cuckoo_zkeys[i] = 0;
+    cuckoo_moves[i] = 0;
+  }
+  for (int color = WHITE; color <= BLACK; color++) {
+    for (int piece = KNIGHT; piece <= KING; piece++) {
+      for (int origin = 0; origin < 64; origin++) {
+        bitboard origin_square = ((bitboard)1) << origin;
+        bitboard attacks =
+            piece == KNIGHT ? knight_moves_lookup[origin]
+            : piece == BISHOP ? generate_bishop_attacks(origin_square, 0)
+            : piece == ROOK   ? generate_rook_attacks(origin_square, 0)
+            : piece == QUEEN  ? generate_bishop_attacks(origin_square, 0) |
+                                   generate_rook_attacks(origin_square, 0)
+                              : king_moves_lookup[origin];
+        // each move is stored once, for either direction
+        for (int destination = origin + 1; destination < 64; destination++) {
+          bitboard destination_square = ((bitboard)1) << destination;
+          if (!(attacks & destination_square)) {
+            continue;
+          }
+          uint16_t move =
+              Move(origin_square, destination_square, 0).get_move_rep();
+          uint64_t key = piece_square_zkeys[color][piece][origin] ^
+                         piece_square_zkeys[color][piece][destination] ^
+                         side_zkey;
+          int index = cuckoo_hash_one(key);
+          while (true) {
+            std::swap(cuckoo_zkeys[index], key);
+            std::swap(cuckoo_moves[index], move);
+            if (!move) {
+              break; // found an empty slot
+            }
+            // the evicted entry moves to its other slot
+            index = index == cuckoo_hash_one(key) ? cuckoo_hash_two(key)
+                                                   : cuckoo_hash_one(key);
+          }
+        }
+      }
+    }
+  }
+}
+
 void Board::init_zobrist_keys() {
   std::mt19937_64 rand_num_gen(1);
 
@@ -587,6 +988,17 @@ void Board::init_zobrist_keys() {
   }
 }
 
+uint64_t Board::generate_pawn_zkey() {
+  uint64_t new_pawn_zkey = 0;
+  for (int color = WHITE; color <= BLACK; color++) {
+    for (bitboard positions = piece_bitboards[color][PAWN]; positions;
+         pop_lsb(positions)) {
+      new_pawn_zkey ^= piece_square_zkeys[color][PAWN][lsb(positions)];
+    }
+  }
+  return new_pawn_zkey;
+}
+
 uint64_t Board::generate_zkey() {
   uint64_t new_zkey = 1;
 
@@ -612,15 +1024,8 @@ uint64_t Board::generate_zkey() {
   if (!is_moves_empty(negate_color(turn_color))) {
     Move last_move = get_last_move(negate_color(turn_color));
     if (last_move.get_flags() == 1) {
-      bitboard origin = last_move.get_origin();
-      bitboard file_masks[8] = {FILE_A, FILE_B, FILE_C, FILE_D,
-                                FILE_E, FILE_F, FILE_G, FILE_H};
-      for (int file_index = 0; file_index < 8; ++file_index) {
-        if (origin & file_masks[file_index]) {
-          new_zkey ^= en_passant_zkeys[file_index];
-          break;
-        }
-      }
+      int file_index = 7 - (lsb(last_move.get_origin()) % 8);
+      new_zkey ^= en_passant_zkeys[file_index];
     }
   }
 
@@ -631,10 +1036,58 @@ uint64_t Board::generate_zkey() {
   return new_zkey;
 }
 
+// Piece-Square Scores:
+int Board::piece_square_scores[2][6][64];
+
+// Material plus piece-square value of every piece on every square, from
+// white's point of view, as packed midgame and endgame scores. Evaluation's
+// tables run from a8 to h1 for white, and are mirrored for black.
+void Board::initialize_piece_square_scores() {
+  for (int color = WHITE; color <= BLACK; color++) {
+    int color_multiplier = color == WHITE ? 1 : -1;
+    for (int piece = PAWN; piece <= KING; piece++) {
+      for (int square_index = 0; square_index < 64; square_index++) {
+        int table_index = 63 - (color == WHITE ? square_index
+                                               : square_index ^ 56);
+        piece_square_scores[color][piece][square_index] =
+            color_multiplier *
+            Evaluation::make_score(
+                Evaluation::mg_piece_values[piece] +
+                    Evaluation::mg_piece_square_tables[piece][table_index],
+                Evaluation::eg_piece_values[piece] +
+                    Evaluation::eg_piece_square_tables[piece][table_index]);
+      }
+    }
+  }
+}
+
+int Board::generate_psq_score() {
+  int score = 0;
+  for (int color = WHITE; color <= BLACK; color++) {
+    for (int piece = PAWN; piece <= KING; piece++) {
+      for (bitboard positions = piece_bitboards[color][piece]; positions;
+           pop_lsb(positions)) {
+        score += piece_square_scores[color][piece][lsb(positions)];
+      }
+    }
+  }
+  return score;
+}
+
+int Board::generate_phase() {
+  int new_phase = 0;
+  for (int piece = PAWN; piece <= KING; piece++) {
+    new_phase +=
+        Evaluation::phase_weights[piece] * popcount(all_piece_bitboards[piece]);
+  }
+  return new_phase;
+}
+
 // Castling:
 void Board::update_castle_rights(Move &move, Piece moving_piece) {
   bitboard origin = move.get_origin();
-  previous_castle_rights[castle_rights_size++] = castle_rights;
+  previous_castle_rights[castle_rights_size++ & (MAX_CASTLE_RIGHTS - 1)] =
+      castle_rights;
   if (moving_piece == KING) {
     if (get_can_castle_king(turn_color)) {
       clear_king_castle_right(turn_color);
@@ -658,7 +1111,8 @@ void Board::update_castle_rights(Move &move, Piece moving_piece) {
 }
 
 void Board::revert_castle_rights(Color color) {
-  uint8_t prev_rights = previous_castle_rights[--castle_rights_size];
+  uint8_t prev_rights =
+      previous_castle_rights[--castle_rights_size & (MAX_CASTLE_RIGHTS - 1)];
   uint8_t changed = prev_rights ^ castle_rights;
   if (changed & 0x8) {
     zkey ^= castling_zkeys[0];
@@ -689,6 +1143,12 @@ void Board::move_piece(Piece piece, Color color, bitboard origin,
 
   zkey ^= piece_square_zkeys[color][piece][lsb(origin)];
   zkey ^= piece_square_zkeys[color][piece][lsb(destination)];
+  psq_score += piece_square_scores[color][piece][lsb(destination)] -
+               piece_square_scores[color][piece][lsb(origin)];
+  if (piece == PAWN) {
+    pawn_zkey ^= piece_square_zkeys[color][PAWN][lsb(origin)] ^
+                 piece_square_zkeys[color][PAWN][lsb(destination)];
+  }
 }
 
 void Board::set_piece(Piece piece, Color color, bitboard position) {
@@ -701,6 +1161,11 @@ void Board::set_piece(Piece piece, Color color, bitboard position) {
   board_pieces[lsb(position)] = piece;
 
   zkey ^= piece_square_zkeys[color][piece][lsb(position)];
+  psq_score += piece_square_scores[color][piece][lsb(position)];
+  phase += Evaluation::phase_weights[piece];
+  if (piece == PAWN) {
+    pawn_zkey ^= piece_square_zkeys[color][PAWN][lsb(position)];
+  }
 }
 
 void Board::remove_piece(Piece piece, Color color, bitboard position) {
@@ -712,6 +1177,11 @@ void Board::remove_piece(Piece piece, Color color, bitboard position) {
 
   board_pieces[lsb(position)] = NONE;
   zkey ^= piece_square_zkeys[color][piece][lsb(position)];
+  psq_score -= piece_square_scores[color][piece][lsb(position)];
+  phase -= Evaluation::phase_weights[piece];
+  if (piece == PAWN) {
+    pawn_zkey ^= piece_square_zkeys[color][PAWN][lsb(position)];
+  }
 }
 
 void Board::execute_castle_move(bitboard king_origin,
@@ -752,28 +1222,16 @@ bitboard Board::get_bishop_attacks(bitboard position) {
   if (!position) {
     return 0;
   }
-  int square_index = lsb(position);
-  bitboard blockers =
-      (get_all_piece_positions(WHITE) | get_all_piece_positions(BLACK)) &
-      BISHOP_MASKS[square_index];
-  uint64_t key =
-      (blockers * BISHOP_MAGICS[square_index]) >> BISHOP_SHIFTS[square_index];
-  bitboard result = bishop_attacks_magic_bb[square_index][key];
-  return result;
+  return get_bishop_attacks(position, get_all_piece_positions(WHITE) |
+                                          get_all_piece_positions(BLACK));
 }
 
 bitboard Board::get_rook_attacks(bitboard position) {
   if (!position) {
     return 0;
   }
-  int square_index = lsb(position);
-  bitboard blockers =
-      (get_all_piece_positions(WHITE) | get_all_piece_positions(BLACK)) &
-      ROOK_MASKS[square_index];
-  uint64_t key =
-      (blockers * ROOK_MAGICS[square_index]) >> ROOK_SHIFTS[square_index];
-  bitboard result = rook_attacks_magic_bb[square_index][key];
-  return result;
+  return get_rook_attacks(position, get_all_piece_positions(WHITE) |
+                                        get_all_piece_positions(BLACK));
 }
 
 bitboard Board::get_queen_attacks(bitboard position) {
@@ -809,9 +1267,6 @@ bitboard Board::get_attacks_to_king(bitboard king_position, Color king_color) {
 // Sliding piece attack generation
 bitboard Board::generate_sliding_attacks(bitboard position, Direction direction,
                                          bitboard blockers) {
-  assert((get_all_piece_positions(WHITE) & get_all_piece_positions(BLACK)) ==
-         0);
-
   bitboard result = 0;
   while ((position & blockers) == 0) {
     position = move_direction(position, direction);
@@ -882,6 +1337,47 @@ Piece Board::get_promotion_piece_from_flags(uint8_t flags) {
   return NONE;
 }
 
+void Board::push_history() {
+  zkey_history[history_size & (MAX_HISTORY - 1)] = zkey;
+  half_moves_history[history_size++ & (MAX_HISTORY - 1)] = half_moves;
+}
+
+// Material won by a move before any recapture, including promotion.
+int Board::get_see_gain(Move &move) {
+  uint8_t flags = move.get_flags();
+  int gain = 0;
+  if (flags == 5) {
+    gain = Evaluation::piece_values[PAWN];
+  } else if (move.is_capture()) {
+    gain = Evaluation::piece_values[board_pieces[lsb(move.get_destination())]];
+  }
+  if (flags >= 8) {
+    gain += Evaluation::piece_values[get_promotion_piece_from_flags(flags)] -
+            Evaluation::piece_values[PAWN];
+  }
+  return gain;
+}
+
+// The piece standing on the destination once the move is made.
+Piece Board::get_see_attacker(Move &move) {
+  uint8_t flags = move.get_flags();
+  return flags >= 8 ? get_promotion_piece_from_flags(flags)
+                    : board_pieces[lsb(move.get_origin())];
+}
+
+// Sets piece to the least valuable of attackers and returns its square.
+bitboard Board::get_least_valuable_attacker(bitboard attackers,
+                                            Piece &piece) {
+  for (int p = PAWN; p <= KING; p++) {
+    bitboard piece_attackers = attackers & all_piece_bitboards[p];
+    if (piece_attackers) {
+      piece = (Piece)p;
+      return piece_attackers & -piece_attackers;
+    }
+  }
+  return 0;
+}
+
 void Board::verify_board_pieces_consistency() {
   for (int square_index = 0; square_index < 64; square_index++) {
     bitboard square = ((uint64_t)1) << square_index;
@@ -897,8 +1393,24 @@ void Board::verify_board_pieces_consistency() {
 }
 
 // Lookup Tables:
-void Board::initialize_lookups() { // Called by constructor
-  initialize_square_lookups();
+std::array<std::array<bitboard, 64>, 2> Board::pawn_single_pushes_lookups;
+std::array<std::array<bitboard, 64>, 2> Board::pawn_double_pushes_lookups;
+std::array<std::array<bitboard, 64>, 2> Board::pawn_attacks_lookups;
+std::array<bitboard, 64> Board::knight_moves_lookup;
+std::array<bitboard, 64> Board::king_moves_lookup;
+std::array<bitboard, 64> Board::castle_rook_origin_lookup;
+std::array<bitboard, 64> Board::castle_rook_destination_lookup;
+std::array<std::array<bitboard, 64>, 64> Board::between_lookup;
+std::array<std::array<bitboard, 64>, 64> Board::line_lookup;
+std::array<std::array<bitboard, 4096>, 64> Board::rook_attacks_magic_bb;
+std::array<std::array<bitboard, 512>, 64> Board::bishop_attacks_magic_bb;
+
+/*
+ * Builds every shared lookup table and the zobrist keys.
+ * Called through a function-local static in the constructor, so it runs
+ * exactly once per process even if boards are created on several threads.
+ */
+bool Board::initialize_lookups() {
   initialize_single_pawn_pushes_lookups();
   initialize_double_pawn_pushes_lookups();
   initialize_pawn_attacks_lookups();
@@ -906,18 +1418,16 @@ void Board::initialize_lookups() { // Called by constructor
   initialize_king_moves_lookup();
   initialize_castle_rook_origin_lookup();
   initialize_castle_rook_destination_lookup();
+  initialize_between_and_line_lookups();
 
   initialize_rook_attacks_magic_bb();
   initialize_bishop_attacks_magic_bb();
-}
 
-void Board::initialize_square_lookups() {
-  bitboard square = 0x8000000000000000;
-  for (int square_index = 63; square_index >= 0; --square_index) {
-    square_lookup[square_index] = square;
-    square_index_lookup[square] = square_index;
-    square >>= 1;
-  }
+  init_zobrist_keys();
+  initialize_cuckoo_tables();
+  initialize_piece_square_scores();
+
+  return true;
 }
 
 void Board::initialize_single_pawn_pushes_lookups() {
@@ -984,9 +1494,35 @@ void Board::initialize_castle_rook_destination_lookup() {
   castle_rook_destination_lookup[lsb(0x20)] = 0x10;
 }
 
+void Board::initialize_between_and_line_lookups() {
+  for (int a_index = 0; a_index < 64; ++a_index) {
+    bitboard a = ((bitboard)1) << a_index;
+    for (int b_index = 0; b_index < 64; ++b_index) {
+      bitboard b = ((bitboard)1) << b_index;
+      between_lookup[a_index][b_index] = 0;
+      line_lookup[a_index][b_index] = 0;
+      if (a == b) {
+        continue;
+      }
+      if (generate_rook_attacks(a, 0) & b) {
+        line_lookup[a_index][b_index] =
+            (generate_rook_attacks(a, 0) & generate_rook_attacks(b, 0)) | a | b;
+        between_lookup[a_index][b_index] =
+            generate_rook_attacks(a, b) & generate_rook_attacks(b, a);
+      } else if (generate_bishop_attacks(a, 0) & b) {
+        line_lookup[a_index][b_index] =
+            (generate_bishop_attacks(a, 0) & generate_bishop_attacks(b, 0)) |
+            a | b;
+        between_lookup[a_index][b_index] =
+            generate_bishop_attacks(a, b) & generate_bishop_attacks(b, a);
+      }
+    }
+  }
+}
+
 void Board::initialize_rook_attacks_magic_bb() {
   for (int square_index = 0; square_index < 64; square_index++) {
-    bitboard square = square_lookup[square_index];
+    bitboard square = ((bitboard)1) << square_index;
 
     bitboard blockers = 0;
     do {
@@ -1005,7 +1541,7 @@ void Board::initialize_rook_attacks_magic_bb() {
 
 void Board::initialize_bishop_attacks_magic_bb() {
   for (int square_index = 0; square_index < 64; square_index++) {
-    bitboard square = square_lookup[square_index];
+    bitboard square = ((bitboard)1) << square_index;
 
     bitboard blockers = 0;
     do {
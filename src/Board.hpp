@@ -10,7 +10,6 @@
 #define BOARD_HPP // GUARD
 
 #include <array>
-#include <map>
 #include <stack>
 #include <stdint.h>
 
@@ -50,12 +49,20 @@ public:
   bool get_can_castle_king(Color color);
   Color get_turn_color();
   std::array<std::array<bitboard, 7>, 2> &get_piece_bitboards();
-  int get_square_index(bitboard square);
-  bitboard get_square(int square_index);
+  inline int get_square_index(bitboard square) { return lsb(square); }
+  inline bitboard get_square(int square_index) {
+    return ((bitboard)1) << square_index;
+  }
   bitboard get_blockers(bitboard position);
   inline unsigned get_half_moves() { return half_moves; }
   inline unsigned get_full_moves() { return full_moves; }
   inline uint64_t get_zkey() { return zkey; }
+  inline uint64_t get_pawn_zkey() { return pawn_zkey; }
+  // Material and piece-square score from white's point of view, packed as
+  // midgame and endgame scores (see Evaluation::make_score):
+  inline int get_psq_score() { return psq_score; }
+  // Non-pawn material left, weighted by Evaluation::phase_weights:
+  inline int get_phase() { return phase; }
 
   // Setters:
   void set_piece_positions(Piece piece, Color color, bitboard new_positions);
@@ -64,23 +71,75 @@ public:
   // Board logic:
   bool is_checked(Color color);
   bool is_move_legal(Move &move, Color color);
+  bitboard get_checkers(Color color);
+  bitboard get_pinned_pieces(Color color);
 
   // Attacks:
   bool is_position_attacked_by(bitboard position, Color color);
+  bitboard get_attackers(bitboard position, Color color, bitboard occupancy);
+  bitboard get_bishop_attacks(bitboard position, bitboard occupancy);
+  bitboard get_rook_attacks(bitboard position, bitboard occupancy);
+  // Squares strictly between two aligned squares, 0 if not aligned:
+  inline bitboard get_squares_between(bitboard a, bitboard b) {
+    return between_lookup[lsb(a)][lsb(b)];
+  }
+  // Full rank, file or diagonal through two aligned squares, 0 if not aligned:
+  inline bitboard get_line_through(bitboard a, bitboard b) {
+    return line_lookup[lsb(a)][lsb(b)];
+  }
   bitboard get_piece_attacks(Piece piece, bitboard position, Color color);
   bitboard get_pawn_single_push(bitboard position, Color color);
   bitboard get_pawn_double_push(bitboard position, Color color);
 
+  // Draws:
+  /*
+   * Whether the position is drawn by the fifty-move rule or by repetition.
+   * Any repetition counts, including a single one, since a side that can
+   * repeat once can repeat again. Checkmate takes precedence over the
+   * fifty-move rule.
+   */
+  bool is_draw();
+  bool is_checkmate();
+  bool is_repetition();
+  /*
+   * Whether the side to move has a reversible move back to a position
+   * reached since the last irreversible move. Only cycles within the last
+   * ply plies, the ones played in the search, are considered.
+   */
+  bool has_upcoming_repetition(unsigned ply);
+
+  // Static Exchange Evaluation:
+  /*
+   * Returns the material balance, in centipawns, of the exchange started by
+   * a move on its destination square, assuming both sides keep capturing
+   * with their least valuable piece while it pays. X-ray attackers behind
+   * sliders are included, pins are ignored.
+   */
+  int see(Move move);
+  // Whether see(move) >= threshold, usually without computing it.
+  bool see_ge(Move move, int threshold);
+
   // Moves:
   void execute_move(Move &move);
   void undo_move(Move &move);
+  /*
+   * Passes the turn. A null move is recorded in the move history, so the
+   * opponent loses any en passant capture and undo_null_move restores it.
+   */
+  void make_null_move();
+  void undo_null_move();
 
   // Print:
   void print();
 
 private:
   Color turn_color; // color who has the current turn
-  Move moves[2][256];
+  // The move, key and castling right stacks below are rings: search only
+  // takes back a few dozen plies and a repetition reaches back at most 100,
+  // so a game of any length overwrites the oldest entries rather than
+  // running out of room. Their sizes count every entry ever pushed.
+  static const size_t MAX_MOVES = 256; // per color, a power of two
+  Move moves[2][MAX_MOVES];
   size_t moves_size[2];
   Piece captured_pieces[2][16];
   size_t captured_pieces_size[2];
@@ -88,19 +147,50 @@ private:
   std::array<bitboard, 7>
       all_piece_bitboards; // all pieces of a type (regardless of color)
   std::array<Piece, 64> board_pieces;
-  unsigned half_moves;
+  unsigned half_moves; // plies since the last capture or pawn move
   unsigned full_moves;
 
-  // Zobrist hashing:
-  uint64_t piece_square_zkeys[2][6]
-                             [64]; // one key for each piece at each square;
-  uint64_t side_zkey;              // one key for when side to move is black
-  uint64_t castling_zkeys[4];      // one key for each castling right
-  uint64_t en_passant_zkeys[8]; // one key for each file of an en passant square
-  void init_zobrist_keys();
+  // Key and half_moves before each move made, game moves included:
+  static const size_t MAX_HISTORY = 256; // a power of two
+  uint64_t zkey_history[MAX_HISTORY];
+  unsigned half_moves_history[MAX_HISTORY];
+  size_t history_size;
+  void push_history();
+
+  // Zobrist hashing (keys are shared by all boards):
+  static uint64_t piece_square_zkeys[2][6][64]; // one key for each piece at
+                                                // each square
+  static uint64_t side_zkey;         // one key for when side to move is black
+  static uint64_t castling_zkeys[4]; // one key for each castling right
+  static uint64_t en_passant_zkeys[8]; // one key for each file of an en
+                                       // passant square
+  static void init_zobrist_keys();
+
+  // Piece-square scores are kept up to date like the zobrist key:
+  static int piece_square_scores[2][6][64]; // from Evaluation's tables
+  static void initialize_piece_square_scores();
+  int psq_score;
+  int phase;
+  int generate_psq_score(); // sums the scores of all pieces from scratch
+  int generate_phase();
+
+  // Cuckoo tables of the key differences of reversible moves, used for
+  // upcoming repetition detection:
+  static const int CUCKOO_SIZE = 8192;
+  static uint64_t cuckoo_zkeys[CUCKOO_SIZE];
+  static uint16_t cuckoo_moves[CUCKOO_SIZE]; // Move representations
+  static void initialize_cuckoo_tables(); // Called by initialize_lookups
+  static inline int cuckoo_hash_one(uint64_t key) {
+    return key & (CUCKOO_SIZE - 1);
+  }
+  static inline int cuckoo_hash_two(uint64_t key) {
+    return (key >> 16) & (CUCKOO_SIZE - 1);
+  }
   uint64_t zkey;
   uint64_t generate_zkey(); // generates zobrist key for the current position
                             // from scratch
+  uint64_t pawn_zkey; // zobrist key of the pawns alone, for the pawn table
+  uint64_t generate_pawn_zkey();
 
   // Castle rights:
   uint8_t castle_rights; // uses the lower 4 bits: white king side, white queen
@@ -121,7 +211,8 @@ private:
     castle_rights &= ~(0x4 >> (color << 1));
     zkey ^= castling_zkeys[(color << 1) + 1];
   }
-  uint8_t previous_castle_rights[512];
+  static const size_t MAX_CASTLE_RIGHTS = 256; // a power of two
+  uint8_t previous_castle_rights[MAX_CASTLE_RIGHTS];
   size_t castle_rights_size;
 
   // Moves -- Called by execute_move, undo_move
@@ -147,47 +238,54 @@ private:
   bitboard get_attacks_to_king(bitboard king_position, Color king_color);
 
   // Sliding piece attack generation:
-  bitboard generate_sliding_attacks(bitboard position, Direction direction,
-                                    bitboard blockers);
-  bitboard generate_bishop_attacks(bitboard position, bitboard blockers);
-  bitboard generate_rook_attacks(bitboard position, bitboard blockers);
+  static bitboard generate_sliding_attacks(bitboard position,
+                                           Direction direction,
+                                           bitboard blockers);
+  static bitboard generate_bishop_attacks(bitboard position, bitboard blockers);
+  static bitboard generate_rook_attacks(bitboard position, bitboard blockers);
 
   // Helpers:
   Piece get_piece_from_index(int index);
-  bitboard move_direction(bitboard position, Direction direction);
+  static bitboard move_direction(bitboard position, Direction direction);
   Piece get_promotion_piece_from_flags(uint8_t flags);
   Piece get_piece_from_char(char piece_char);
+  int get_see_gain(Move &move);
+  Piece get_see_attacker(Move &move);
+  bitboard get_least_valuable_attacker(bitboard attackers, Piece &piece);
   bitboard get_end_edge_mask(Direction direction);
   void verify_board_pieces_consistency();
 
   // Lookup Tables:
-  std::map<int, bitboard> square_lookup;
-  std::map<bitboard, int> square_index_lookup;
-  std::array<std::array<bitboard, 64>, 2> pawn_single_pushes_lookups;
-  std::array<std::array<bitboard, 64>, 2> pawn_double_pushes_lookups;
-  std::array<std::array<bitboard, 64>, 2> pawn_attacks_lookups;
-  std::array<bitboard, 64> knight_moves_lookup;
-  std::array<bitboard, 64> king_moves_lookup;
-  std::array<bitboard, 64> castle_rook_origin_lookup;
-  std::array<bitboard, 64> castle_rook_destination_lookup;
+  // The tables below depend only on the geometry of the board, so they are
+  // built once per process and shared by every Board instance.
+  static std::array<std::array<bitboard, 64>, 2> pawn_single_pushes_lookups;
+  static std::array<std::array<bitboard, 64>, 2> pawn_double_pushes_lookups;
+  static std::array<std::array<bitboard, 64>, 2> pawn_attacks_lookups;
+  static std::array<bitboard, 64> knight_moves_lookup;
+  static std::array<bitboard, 64> king_moves_lookup;
+  static std::array<bitboard, 64> castle_rook_origin_lookup;
+  static std::array<bitboard, 64> castle_rook_destination_lookup;
+  static std::array<std::array<bitboard, 64>, 64> between_lookup;
+  static std::array<std::array<bitboard, 64>, 64> line_lookup;
 
   // Magic Bitboards:
-  std::array<std::array<bitboard, 4096>, 64> rook_attacks_magic_bb;
-  std::array<std::array<bitboard, 4096>, 64> bishop_attacks_magic_bb;
+  // Rook keys use at most 12 bits, bishop keys at most 9 bits.
+  static std::array<std::array<bitboard, 4096>, 64> rook_attacks_magic_bb;
+  static std::array<std::array<bitboard, 512>, 64> bishop_attacks_magic_bb;
 
   // Initialize Lookup Tables:
-  void initialize_lookups(); // Called by constructor
-  void initialize_square_lookups();
-  void initialize_single_pawn_pushes_lookups();
-  void initialize_double_pawn_pushes_lookups();
-  void initialize_pawn_attacks_lookups();
-  void initialize_knight_moves_lookup();
-  void initialize_king_moves_lookup();
-  void initialize_castle_rook_origin_lookup();
-  void initialize_castle_rook_destination_lookup();
+  static bool initialize_lookups(); // Called once by the first constructor
+  static void initialize_single_pawn_pushes_lookups();
+  static void initialize_double_pawn_pushes_lookups();
+  static void initialize_pawn_attacks_lookups();
+  static void initialize_knight_moves_lookup();
+  static void initialize_king_moves_lookup();
+  static void initialize_castle_rook_origin_lookup();
+  static void initialize_castle_rook_destination_lookup();
+  static void initialize_between_and_line_lookups();
   // Initialize Magic Bitboards
-  void initialize_rook_attacks_magic_bb();
-  void initialize_bishop_attacks_magic_bb();
+  static void initialize_rook_attacks_magic_bb();
+  static void initialize_bishop_attacks_magic_bb();
 
   static const bitboard white_queenside_castle_king_position;
   static const bitboard white_queenside_castle_rook_position;
@@ -5,41 +5,71 @@
 #include "Engine.hpp"
 #include "MoveList.hpp"
 
+#include <algorithm>
+
 #ifndef ENGINE_CPP // GUARD
 #define ENGINE_CPP // GUARD
 
 Engine::Engine() {
-  white_increment = 0;
-  black_increment = 0;
   time_divider = 50;
-  time_set = false;
+  clear_time_control();
 }
 
+void Engine::start_new_game() { thread_pool.clear(); }
+
 bool Engine::set_position(std::string fen_string) {
   return board.initialize_fen(fen_string);
 }
 
 bool Engine::play_move(std::string move_str) {
-  MoveList pseudo_legal_moves =
-      move_gen.generate_pseudo_legal_moves(board, board.get_turn_color());
-  for (int i = 0; i < pseudo_legal_moves.size(); ++i) {
-    if (move_str == pseudo_legal_moves[i].to_uci_notation()) {
-      board.execute_move(pseudo_legal_moves[i]);
-      if (board.is_checked(negate_color(board.get_turn_color()))) {
-        board.undo_move(pseudo_legal_moves[i]);
-        return false;
-      }
-      return true;
+  Move move = get_legal_move(move_str);
+  if (move.is_null()) {
+    return false;
+  }
+  board.execute_move(move);
+  return true;
+}
+
+Move Engine::get_legal_move(std::string move_str) {
+  MoveList legal_moves =
+      move_gen.generate_legal_moves(board, board.get_turn_color());
+  for (int i = 0; i < legal_moves.size(); ++i) {
+    if (move_str == legal_moves[i].to_uci_notation()) {
+      return legal_moves[i];
     }
   }
-  return false;
+  return Move();
+}
+
+void Engine::search_best_move(SearchLimits limits) {
+  // with a clock, no iteration is started past half the budget, and a
+  // running one is aborted at twice the budget or a third of the clock,
+  // whichever is first
+  if (time_set && !limits.soft_time) {
+    unsigned search_time = get_time_for_move();
+    unsigned time_left =
+        board.get_turn_color() == WHITE ? white_time : black_time;
+    limits.soft_time = std::max(search_time / 2, 1u);
+    limits.hard_time =
+        std::max(std::min(2 * search_time, std::max(search_time, time_left / 3)),
+                 1u);
+  }
+  // go on its own searches until stopped
+  if (!limits.depth && !limits.nodes && !limits.mate && !limits.soft_time) {
+    limits.infinite = true;
+  }
+  thread_pool.start_search(limits, board, [](Move move) {
+    std::cout << "bestmove " << move.to_uci_notation() << std::endl;
+  });
 }
 
-void Engine::search_best_move() {
-  unsigned search_time = get_time_for_move();
-  search.negamax_root_iterative_deepening(search_time, board, move_gen, eval);
-  Move move = search.get_best_move();
-  std::cout << "bestmove " << move.to_uci_notation() << std::endl;
+void Engine::clear_time_control() {
+  white_time = 0;
+  black_time = 0;
+  white_increment = 0;
+  black_increment = 0;
+  moves_to_go = 0;
+  time_set = false;
 }
 
 unsigned Engine::get_time_for_move() {
@@ -61,9 +91,8 @@ unsigned Engine::get_time_for_move() {
                                      (0.7 * moves_to_go + 3);
       }
     }
-  } else {
-    return 3000;
   }
+  return 0;
 }
 
 #endif // GUARD
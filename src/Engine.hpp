@@ -3,9 +3,9 @@
  */
 
 #include "Board.hpp"
-#include "Evaluation.hpp"
 #include "MoveGenerator.hpp"
 #include "Search.hpp"
+#include "ThreadPool.hpp"
 
 #ifndef ENGINE_HPP // GUARD
 #define ENGINE_HPP // GUARD
@@ -17,7 +17,7 @@ public:
   /*
    * Starts a new game.
    */
-  void start_new_game(); // TODO
+  void start_new_game();
 
   /*
    * Sets up the position described in fen on the board
@@ -32,15 +32,53 @@ public:
   bool play_move(std::string move_str);
 
   /*
-   * Finds the best engine move.
+   * Returns the legal move given in long algebraic notation, or a null move
+   * if there is none.
    */
-  void search_best_move();
+  Move get_legal_move(std::string move_str);
+
+  /*
+   * Starts searching for the best engine move within limits on another
+   * thread, which reports it once the search is over. Limits without a time
+   * are filled in from the clock set with the setters below.
+   */
+  void search_best_move(SearchLimits limits);
+
+  /*
+   * Stops a running search and waits for it to report its best move.
+   */
+  inline void stop() { thread_pool.stop(); }
+
+  /*
+   * Starts the clock of a pondering search, once the opponent has played the
+   * expected move.
+   */
+  inline void ponderhit() { thread_pool.ponderhit(); }
 
   inline void show_board() { board.print(); }
 
   unsigned get_time_for_move();
 
+  /*
+   * Sets the number of threads searching in parallel.
+   */
+  inline void set_thread_count(unsigned thread_count) {
+    thread_pool.set_thread_count(thread_count);
+  }
+
+  /*
+   * Resizes the transposition table to size_mb MiB, or less if that much
+   * cannot be allocated. Returns the MiB used, 0 if the old table is kept.
+   */
+  inline size_t set_hash_size(size_t size_mb) {
+    return thread_pool.set_hash_size(size_mb);
+  }
+
   // Setters:
+  /*
+   * Forgets the clock given for the previous search.
+   */
+  void clear_time_control();
   inline void set_white_time(unsigned wtime) {
     white_time = wtime;
     time_set = true;
@@ -65,8 +103,7 @@ public:
 private:
   Board board;
   MoveGenerator move_gen;
-  Search search;
-  Evaluation eval;
+  ThreadPool thread_pool;
 
   unsigned time_divider;
 
@@ -2,30 +2,142 @@
 #define EVALUATION_CPP // GUARD
 
 #include "Evaluation.hpp"
+#include <algorithm>
 // #include "globals.cpp"
 
 // Constructor:
 Evaluation::Evaluation() {}
 
 // Evaluate:
+// Material and piece-square terms are summed by Board as pieces move, and
+// blended here from the midgame score to the endgame score as material leaves.
 int Evaluation::evaluate(Board &board) {
+  int score = board.get_psq_score() + probe_pawn_table(board).score +
+              evaluate_shelter(board, WHITE) - evaluate_shelter(board, BLACK);
+  int phase = std::min(board.get_phase(), MAX_PHASE); // promotions can exceed
+  return (get_mg_score(score) * phase +
+          get_eg_score(score) * (MAX_PHASE - phase)) /
+         MAX_PHASE;
+}
+
+// Pawn Structure:
+PawnEntry &Evaluation::probe_pawn_table(Board &board) {
+  uint64_t pawn_zkey = board.get_pawn_zkey();
+  PawnEntry &entry = pawn_table.get_entry(pawn_zkey);
+  if (entry.pawn_zkey != pawn_zkey) {
+    entry.pawn_zkey = pawn_zkey;
+    entry.score = evaluate_pawns(board, entry.passed_pawns);
+  }
+  return entry;
+}
+
+int Evaluation::evaluate_pawns(Board &board, bitboard passed_pawns[2]) {
   int score = 0;
-  for (Color color = WHITE; color <= BLACK; color = (Color)(color + 1)) {
-    int color_multiplier = color == WHITE ? 1 : -1;
-    for (Piece piece = PAWN; piece <= KING; piece = (Piece)(piece + 1)) {
-      bitboard piece_positions = board.get_piece_positions(piece, color);
-      while (piece_positions) {
-        score += color_multiplier *
-                 (piece_values[piece] +
-                  piece_square_tables[color][piece][lsb(piece_positions)]);
-        piece_positions &= piece_positions - 1;
+  for (int color = WHITE; color <= BLACK; color++) {
+    bitboard own_pawns = board.get_piece_positions(PAWN, (Color)color);
+    bitboard enemy_pawns =
+        board.get_piece_positions(PAWN, negate_color((Color)color));
+    int direction = color == WHITE ? 1 : -1;
+    int color_score = 0;
+    passed_pawns[color] = 0;
+
+    for (bitboard pawns = own_pawns; pawns; pop_lsb(pawns)) {
+      int square_index = lsb(pawns);
+      int rank = square_index / 8;
+      bitboard file = FILE_H << (square_index & 7);
+      bitboard adjacent_files = get_adjacent_files(file);
+      bitboard rank_mask = RANK_1 << (8 * rank);
+      bitboard rank_behind_mask = RANK_1 << (8 * (rank - direction));
+
+      bool doubled =
+          own_pawns & get_front_span((Color)color, square_index, file);
+      if (doubled) {
+        color_score += doubled_pawn_score;
+      }
+
+      if ((own_pawns & adjacent_files) == 0) {
+        color_score += isolated_pawn_score;
+      } else if ((own_pawns & adjacent_files & (rank_mask | rank_behind_mask)) !=
+                 0) {
+        color_score += connected_pawn_score;
+      } else if ((own_pawns & adjacent_files &
+                  ~get_front_span((Color)color, square_index,
+                                  adjacent_files)) == 0) {
+        // nothing can support it, and a pawn guards the square in front
+        int guard_rank = rank + 2 * direction;
+        if (guard_rank >= 0 && guard_rank <= 7 &&
+            (enemy_pawns & adjacent_files & (RANK_1 << (8 * guard_rank)))) {
+          color_score += backward_pawn_score;
+        }
+      }
+
+      if (!doubled &&
+          (enemy_pawns & get_front_span((Color)color, square_index,
+                                        file | adjacent_files)) == 0) {
+        passed_pawns[color] |= board.get_square(square_index);
+        color_score +=
+            passed_pawn_scores[color == WHITE ? rank : 7 - rank];
       }
     }
+    score += color == WHITE ? color_score : -color_score;
   }
+  return score;
+}
 
+int Evaluation::evaluate_shelter(Board &board, Color color) {
+  bitboard king = board.get_piece_positions(KING, color);
+  if (king == 0) {
+    return 0;
+  }
+  int king_index = lsb(king);
+  int king_rank = color == WHITE ? king_index / 8 : 7 - king_index / 8;
+  if (king_rank > 1) { // only a king on its back ranks is sheltered
+    return 0;
+  }
+
+  int direction = color == WHITE ? 1 : -1;
+  bitboard one_ahead = RANK_1 << (8 * (king_index / 8 + direction));
+  bitboard two_ahead = RANK_1 << (8 * (king_index / 8 + 2 * direction));
+  bitboard own_pawns = board.get_piece_positions(PAWN, color);
+  int king_file = king_index & 7;
+  int score = 0;
+  for (int file_index = std::max(king_file - 1, 0);
+       file_index <= std::min(king_file + 1, 7); file_index++) {
+    bitboard file_pawns = own_pawns & (FILE_H << file_index);
+    score += shelter_pawn_scores[file_pawns & one_ahead   ? 0
+                                 : file_pawns & two_ahead ? 1
+                                                          : 2];
+  }
   return score;
 }
 
+// Pawn Structure Scores:
+const int Evaluation::doubled_pawn_score = make_score(-10, -20);
+const int Evaluation::isolated_pawn_score = make_score(-10, -15);
+const int Evaluation::backward_pawn_score = make_score(-8, -10);
+const int Evaluation::connected_pawn_score = make_score(8, 6);
+const int Evaluation::passed_pawn_scores[8] = {
+    make_score(0, 0),   make_score(0, 5),   make_score(5, 10),
+    make_score(10, 20), make_score(20, 35), make_score(35, 60),
+    make_score(55, 90), make_score(0, 0)};
+const int Evaluation::shelter_pawn_scores[3] = {
+    make_score(10, 0), // one rank ahead of the king
+    make_score(5, 0),  // two ranks ahead
+    make_score(-15, 0) // neither
+};
+
+// Helpers:
+// Squares on the given files on the ranks in front of square_index, as seen
+// by color.
+bitboard Evaluation::get_front_span(Color color, int square_index,
+                                    bitboard files) {
+  int rank = square_index / 8;
+  if (color == WHITE) {
+    return rank == 7 ? 0 : files & (~(bitboard)0 << (8 * (rank + 1)));
+  }
+  return files & ((((bitboard)1) << (8 * rank)) - 1);
+}
+
 // Piece Values:
 const uint16_t Evaluation::piece_values[6] = {
     100,  // PAWN
@@ -36,227 +148,149 @@ const uint16_t Evaluation::piece_values[6] = {
     20000 // KING
 };
 
-// Piece Square Tables:
-const int8_t Evaluation::piece_square_tables[2][6][64] = {
-    { // WHITE
-     {// PAWN
-      0,  0,  0,   0,  0,  0,   0,  0,  5,  10, 10, -20, -20, 10, 10, 5,
-      5,  -5, -10, 0,  0,  -10, -5, 5,  0,  0,  0,  20,  20,  0,  0,  0,
-      5,  5,  10,  25, 25, 10,  5,  5,  10, 10, 20, 30,  30,  20, 10, 10,
-      50, 50, 50,  50, 50, 50,  50, 50, 0,  0,  0,  0,   0,   0,  0,  0},
-     {// KNIGHT
-      -50, -40, -30, -30, -30, -30, -40, -50, -40, -20, 0,   5,   5,
-      0,   -20, -40, -30, 5,   10,  15,  15,  10,  5,   -30, -30, 0,
-      15,  20,  20,  15,  0,   -30, -30, 5,   15,  20,  20,  15,  5,
-      -30, -30, 0,   10,  15,  15,  10,  0,   -30, -40, -20, 0,   0,
-      0,   0,   -20, -40, -50, -40, -30, 30,  -30, -30, -40, -50},
-     {// BISHOP
-      -20, -10, -10, -10, -10, -10, -10, -20, -10, 0,   0,   0,   0,
-      0,   0,   -10, -10, 0,   5,   10,  10,  5,   0,   -10, -10, 5,
-      5,   10,  10,  5,   5,   -10, -10, 0,   10,  10,  10,  10,  0,
-      -10, -10, 10,  10,  10,  10,  10,  10,  -10, -10, 5,   0,   0,
-      0,   0,   5,   -10, -20, -10, -10, -10, -10, -10, -10, -20},
-     {// ROOK
-      0,  0,  0,  5,  5,  0,  0,  0,  -5, 0, 0, 0, 0, 0, 0, -5,
-      -5, 0,  0,  0,  0,  0,  0,  -5, -5, 0, 0, 0, 0, 0, 0, -5,
-      -5, 0,  0,  0,  0,  0,  0,  -5, -5, 0, 0, 0, 0, 0, 0, -5,
-      5,  10, 10, 10, 10, 10, 10, 5,  0,  0, 0, 0, 0, 0, 0, 0},
-     {// QUEEN
-      -20, -10, -10, -5,  -5,  -10, -10, -20 - 10, 0,   5,   0,  0, 0,
-      0,   -10, -10, 5,   5,   5,   5,   5,        0,   -10, 0,  0, 5,
-      5,   5,   5,   0,   -5,  -5,  0,   5,        5,   5,   5,  0, -5,
-      -10, 0,   5,   5,   5,   5,   0,   -10,      -10, 0,   0,  0, 0,
-      0,   0,   -10, -20, -10, -10, -5,  -5,       -10, -10, -20},
-     {// KING
-      20,  30,  10,  0,   0,   10,  30,  20,  20,  20,  0,   0,   0,
-      0,   20,  20,  -10, -20, -20, -20, -20, -20, -20, -10, -20, -30,
-      -30, -40, -40, -30, -30, -20, -30, -40, -40, -50, -50, -40, -40,
-      -30, -30, -40, -40, -50, -50, -40, -40, -30, -30, -40, -40, -50,
-      -50, -40, -40, -30, -30, -40, -40, -50, -50, -40, -40, -30}},
-    {// BLACK
-     {
-         // PAWN
-         0,  0,  0,  0,   0,   0,  0,  0,  50, 50, 50,  50, 50, 50,  50, 50,
-         10, 10, 20, 30,  30,  20, 10, 10, 5,  5,  10,  25, 25, 10,  5,  5,
-         0,  0,  0,  20,  20,  0,  0,  0,  5,  -5, -10, 0,  0,  -10, -5, 5,
-         5,  10, 10, -20, -20, 10, 10, 5,  0,  0,  0,   0,  0,  0,   0,  0,
-     },
-     {
-         // KNIGHT
-         -50, -40, -30, 30,  -30, -30, -40, -50, -40, -20, 0,   0,   0,
-         0,   -20, -40, -30, 0,   10,  15,  15,  10,  0,   -30, -30, 5,
-         15,  20,  20,  15,  5,   -30, -30, 0,   15,  20,  20,  15,  0,
-         -30, -30, 0,   10,  15,  15,  10,  0,   -30, -40, -20, 0,   5,
-         5,   0,   -20, -40, -50, -40, -30, -30, -30, -30, -40, -50,
-     },
-     {
-         // BISHOP
-         -20, -10, -10, -10, -10, -10, -10, -20, -10, 5,   0,   0,   0,
-         0,   5,   -10, -10, 10,  10,  10,  10,  10,  10,  -10, -10, 0,
-         10,  10,  10,  10,  0,   -10, -10, 5,   5,   10,  10,  5,   5,
-         -10, -10, 0,   5,   10,  10,  5,   0,   -10, -10, 0,   0,   0,
-         0,   0,   0,   -10, -20, -10, -10, -10, -10, -10, -10, -20,
-     },
-     {// ROOK
-      0,  0, 0, 0, 0, 0, 0, 0,  5,  10, 10, 10, 10, 10, 10, 5,
-      -5, 0, 0, 0, 0, 0, 0, -5, -5, 0,  0,  0,  0,  0,  0,  -5,
-      -5, 0, 0, 0, 0, 0, 0, -5, -5, 0,  0,  0,  0,  0,  0,  -5,
-      -5, 0, 0, 0, 0, 0, 0, -5, 0,  0,  0,  5,  5,  0,  0,  0},
-     {// QUEEN
-      -20, -10, -10, -5,  -5,  -10, -10, -20, -10, 0,   0,   0,  0,
-      0,   0,   -10, -10, 0,   5,   5,   5,   5,   0,   -10, -5, 0,
-      5,   5,   5,   5,   0,   -5,  0,   0,   5,   5,   5,   5,  0,
-      -5,  -10, 5,   5,   5,   5,   5,   0,   -10, -10, 0,   5,  0,
-      0,   0,   0,   -10, -20, -10, -10, -5,  -5,  -10, -10, -20},
-     {
-         // KING
-         -30, -40, -40, -50, -50, -40, -40, -30, -30, -40, -40, -50, -50,
-         -40, -40, -30, -30, -40, -40, -50, -50, -40, -40, -30, -30, -40,
-         -40, -50, -50, -40, -40, -30, -20, -30, -30, -40, -40, -30, -30,
-         -20, -10, -20, -20, -20, -20, -20, -20, -10, 20,  20,  0,   0,
-         0,   0,   20,  20,  20,  30,  10,  0,   0,   10,  30,  20,
-     }}};
-
-/*
- * Pawn piece-square table:
- * 0,  0,  0,  0,  0,  0,  0,  0,
- * 50, 50, 50, 50, 50, 50, 50, 50,
- * 10, 10, 20, 30, 30, 20, 10, 10,
- * 5,  5, 10, 25, 25, 10,  5,  5,
- * 0,  0,  0, 20, 20,  0,  0,  0,
- * 5, -5, -10,  0,  0, -10, -5,  5,
- * 5, 10, 10, -20, -20, 10, 10,  5,
- * 0,  0,  0,  0,  0,  0,  0,  0
- */
-const int8_t pawn_square_table[2][64] = {
-    {0,  0,  0,   0,  0,  0,   0,  0,  5,  10, 10, -20, -20, 10, 10, 5,
-     5,  -5, -10, 0,  0,  -10, -5, 5,  0,  0,  0,  20,  20,  0,  0,  0,
-     5,  5,  10,  25, 25, 10,  5,  5,  10, 10, 20, 30,  30,  20, 10, 10,
-     50, 50, 50,  50, 50, 50,  50, 50, 0,  0,  0,  0,   0,   0,  0,  0},
-    {
-        0,  0,  0,  0,   0,   0,  0,  0,  50, 50, 50,  50, 50, 50,  50, 50,
-        10, 10, 20, 30,  30,  20, 10, 10, 5,  5,  10,  25, 25, 10,  5,  5,
-        0,  0,  0,  20,  20,  0,  0,  0,  5,  -5, -10, 0,  0,  -10, -5, 5,
-        5,  10, 10, -20, -20, 10, 10, 5,  0,  0,  0,   0,  0,  0,   0,  0,
-    }};
-
-/*
- * Knight piece-square table:
- * -50,-40,-30,-30,-30,-30,-40,-50,
- * -40,-20,  0,  0,  0,  0,-20,-40,
- * -30,  0, 10, 15, 15, 10,  0,-30,
- * -30,  5, 15, 20, 20, 15,  5,-30,
- * -30,  0, 15, 20, 20, 15,  0,-30,
- * -30,  5, 10, 15, 15, 10,  5,-30,
- * -40,-20,  0,  5,  5,  0,-20,-40,
- * -50,-40,-30,-30,-30,-30,-40,-50,
- */
-const int8_t knight_square_table[2][64] = {
-    {-50, -40, -30, -30, -30, -30, -40, -50, -40, -20, 0,   5,   5,
-     0,   -20, -40, -30, 5,   10,  15,  15,  10,  5,   -30, -30, 0,
-     15,  20,  20,  15,  0,   -30, -30, 5,   15,  20,  20,  15,  5,
-     -30, -30, 0,   10,  15,  15,  10,  0,   -30, -40, -20, 0,   0,
-     0,   0,   -20, -40, -50, -40, -30, 30,  -30, -30, -40, -50},
-    {
-        -50, -40, -30, 30,  -30, -30, -40, -50, -40, -20, 0,   0,   0,   0,
-        -20, -40, -30, 0,   10,  15,  15,  10,  0,   -30, -30, 5,   15,  20,
-        20,  15,  5,   -30, -30, 0,   15,  20,  20,  15,  0,   -30, -40, -20,
-        0,   5,   5,   0,   -20, -40, -50, -40, -30, -30, -30, -30, -40, -50,
-    }};
-
-/*
- * Bishop piece-square table:
- * -20,-10,-10,-10,-10,-10,-10,-20,
- * -10,  0,  0,  0,  0,  0,  0,-10,
- * -10,  0,  5, 10, 10,  5,  0,-10,
- * -10,  5,  5, 10, 10,  5,  5,-10,
- * -10,  0, 10, 10, 10, 10,  0,-10,
- * -10, 10, 10, 10, 10, 10, 10,-10,
- * -10,  5,  0,  0,  0,  0,  5,-10,
- * -20,-10,-10,-10,-10,-10,-10,-20,
- */
-const int8_t bishop_square_table[2][64] = {
-    {-20, -10, -10, -10, -10, -10, -10, -20, -10, 0,   0,   0,   0,
-     0,   0,   -10, -10, 0,   5,   10,  10,  5,   0,   -10, -10, 5,
-     5,   10,  10,  5,   5,   -10, -10, 0,   10,  10,  10,  10,  0,
-     -10, -10, 10,  10,  10,  10,  10,  10,  -10, -10, 5,   0,   0,
-     0,   0,   5,   -10, -20, -10, -10, -10, -10, -10, -10, -20},
-    {
-        -20, -10, -10, -10, -10, -10, -10, -20, -10, 5,   0,   0,   0,
-        0,   5,   -10, -10, 10,  10,  10,  10,  10,  10,  -10, -10, 0,
-        10,  10,  10,  10,  0,   -10, -10, 5,   5,   10,  10,  5,   5,
-        -10, -10, 0,   5,   10,  10,  5,   0,   -10, -10, 0,   0,   0,
-        0,   0,   0,   -10, -20, -10, -10, -10, -10, -10, -10, -20,
-    }};
+// Tapered Piece Values:
+// Both sides always have a king, so it is worth nothing here.
+const int16_t Evaluation::mg_piece_values[6] = {
+    100, // PAWN
+    320, // KNIGHT
+    330, // BISHOP
+    500, // ROOK
+    900, // QUEEN
+    0    // KING
+};
 
-/*
- * Rook piece-square table:
- * 0,  0,  0,  0,  0,  0,  0,  0,
- * 5, 10, 10, 10, 10, 10, 10,  5,
- * -5,  0,  0,  0,  0,  0,  0, -5,
- * -5,  0,  0,  0,  0,  0,  0, -5,
- * -5,  0,  0,  0,  0,  0,  0, -5,
- * -5,  0,  0,  0,  0,  0,  0, -5,
- * -5,  0,  0,  0,  0,  0,  0, -5,
- * 0,  0,  0,  5,  5,  0,  0,  0
- */
-const int8_t rook_square_table[2][64] = {
-    {0,  0,  0,  5,  5,  0,  0,  0 - 5, 0, 0, 0, 0, 0, 0, -5, -5,
-     0,  0,  0,  0,  0,  0,  -5, -5,    0, 0, 0, 0, 0, 0, -5, -5,
-     0,  0,  0,  0,  0,  0,  -5, -5,    0, 0, 0, 0, 0, 0, -5, 5,
-     10, 10, 10, 10, 10, 10, 5,  0,     0, 0, 0, 0, 0, 0, 0},
-    {0,  0, 0, 0, 0, 0, 0, 0,  5,  10, 10, 10, 10, 10, 10, 5,
-     -5, 0, 0, 0, 0, 0, 0, -5, -5, 0,  0,  0,  0,  0,  0,  -5,
-     -5, 0, 0, 0, 0, 0, 0, -5, -5, 0,  0,  0,  0,  0,  0,  -5,
-     -5, 0, 0, 0, 0, 0, 0, -5, 0,  0,  0,  5,  5,  0,  0,  0}};
+const int16_t Evaluation::eg_piece_values[6] = {
+    110, // PAWN
+    300, // KNIGHT
+    320, // BISHOP
+    520, // ROOK
+    940, // QUEEN
+    0    // KING
+};
 
-/*
- * Queen piece-square table:
- * -20,-10,-10, -5, -5,-10,-10,-20,
- * -10,  0,  0,  0,  0,  0,  0,-10,
- * -10,  0,  5,  5,  5,  5,  0,-10,
- * -5,  0,  5,  5,  5,  5,  0, -5,
- *  0,  0,  5,  5,  5,  5,  0, -5,
- * -10,  5,  5,  5,  5,  5,  0,-10,
- * -10,  0,  5,  0,  0,  0,  0,-10,
- * -20,-10,-10, -5, -5,-10,-10,-20
- */
+// Game Phase:
+const int Evaluation::phase_weights[6] = {
+    0, // PAWN
+    1, // KNIGHT
+    1, // BISHOP
+    2, // ROOK
+    4, // QUEEN
+    0  // KING
+};
+const int Evaluation::MAX_PHASE;
 
-const int8_t queen_square_table[2][64] = {
-    {-20, -10, -10, -5,  -5,  -10, -10, -20 - 10, 0,   5,   0,  0, 0,
-     0,   -10, -10, 5,   5,   5,   5,   5,        0,   -10, 0,  0, 5,
-     5,   5,   5,   0,   -5,  -5,  0,   5,        5,   5,   5,  0, -5,
-     -10, 0,   5,   5,   5,   5,   0,   -10,      -10, 0,   0,  0, 0,
-     0,   0,   -10, -20, -10, -10, -5,  -5,       -10, -10, -20},
-    {-20, -10, -10, -5,  -5,  -10, -10, -20, -10, 0,   0,   0,  0,
-     0,   0,   -10, -10, 0,   5,   5,   5,   5,   0,   -10, -5, 0,
-     5,   5,   5,   5,   0,   -5,  0,   0,   5,   5,   5,   5,  0,
-     -5,  -10, 5,   5,   5,   5,   5,   0,   -10, -10, 0,   5,  0,
-     0,   0,   0,   -10, -20, -10, -10, -5,  -5,  -10, -10, -20}};
+// Midgame Piece-Square Tables:
+const int8_t Evaluation::mg_piece_square_tables[6][64] = {
+    {// PAWN
+     0,  0,  0,  0,   0,   0,  0,  0,  //
+     50, 50, 50, 50,  50,  50, 50, 50, //
+     10, 10, 20, 30,  30,  20, 10, 10, //
+     5,  5,  10, 25,  25,  10, 5,  5,  //
+     0,  0,  0,  20,  20,  0,  0,  0,  //
+     5,  -5, -10, 0,  0,   -10, -5, 5, //
+     5,  10, 10, -20, -20, 10, 10, 5,  //
+     0,  0,  0,  0,   0,   0,  0,  0},
+    {// KNIGHT
+     -50, -40, -30, -30, -30, -30, -40, -50, //
+     -40, -20, 0,   0,   0,   0,   -20, -40, //
+     -30, 0,   10,  15,  15,  10,  0,   -30, //
+     -30, 5,   15,  20,  20,  15,  5,   -30, //
+     -30, 0,   15,  20,  20,  15,  0,   -30, //
+     -30, 5,   10,  15,  15,  10,  5,   -30, //
+     -40, -20, 0,   5,   5,   0,   -20, -40, //
+     -50, -40, -30, -30, -30, -30, -40, -50},
+    {// BISHOP
+     -20, -10, -10, -10, -10, -10, -10, -20, //
+     -10, 0,   0,   0,   0,   0,   0,   -10, //
+     -10, 0,   5,   10,  10,  5,   0,   -10, //
+     -10, 5,   5,   10,  10,  5,   5,   -10, //
+     -10, 0,   10,  10,  10,  10,  0,   -10, //
+     -10, 10,  10,  10,  10,  10,  10,  -10, //
+     -10, 5,   0,   0,   0,   0,   5,   -10, //
+     -20, -10, -10, -10, -10, -10, -10, -20},
+    {// ROOK
+     0,  0,  0,  0,  0,  0,  0,  0,  //
+     5,  10, 10, 10, 10, 10, 10, 5,  //
+     -5, 0,  0,  0,  0,  0,  0,  -5, //
+     -5, 0,  0,  0,  0,  0,  0,  -5, //
+     -5, 0,  0,  0,  0,  0,  0,  -5, //
+     -5, 0,  0,  0,  0,  0,  0,  -5, //
+     -5, 0,  0,  0,  0,  0,  0,  -5, //
+     0,  0,  0,  5,  5,  0,  0,  0},
+    {// QUEEN
+     -20, -10, -10, -5, -5, -10, -10, -20, //
+     -10, 0,   0,   0,  0,  0,   0,   -10, //
+     -10, 0,   5,   5,  5,  5,   0,   -10, //
+     -5,  0,   5,   5,  5,  5,   0,   -5,  //
+     0,   0,   5,   5,  5,  5,   0,   -5,  //
+     -10, 5,   5,   5,  5,  5,   0,   -10, //
+     -10, 0,   5,   0,  0,  0,   0,   -10, //
+     -20, -10, -10, -5, -5, -10, -10, -20},
+    {// KING, sheltered behind its pawns
+     -30, -40, -40, -50, -50, -40, -40, -30, //
+     -30, -40, -40, -50, -50, -40, -40, -30, //
+     -30, -40, -40, -50, -50, -40, -40, -30, //
+     -30, -40, -40, -50, -50, -40, -40, -30, //
+     -20, -30, -30, -40, -40, -30, -30, -20, //
+     -10, -20, -20, -20, -20, -20, -20, -10, //
+     20,  20,  0,   0,   0,   0,   20,  20,  //
+     20,  30,  10,  0,   0,   10,  30,  20}};
 
-/*
- * King piece-square table.
- * -30,-40,-40,-50,-50,-40,-40,-30,
- * -30,-40,-40,-50,-50,-40,-40,-30,
- * -30,-40,-40,-50,-50,-40,-40,-30,
- * -30,-40,-40,-50,-50,-40,-40,-30,
- * -20,-30,-30,-40,-40,-30,-30,-20,
- * -10,-20,-20,-20,-20,-20,-20,-10,
- * 20, 20,  0,  0,  0,  0, 20, 20,
- * 20, 30, 10,  0,  0, 10, 30, 20
- */
-const int8_t king_square_table[2][64] = {
-    {20,  30,  10,  0,   0,   10,  30,  20,  20,  20,  0,   0,   0,
-     0,   20,  20,  -10, -20, -20, -20, -20, -20, -20, -10, -20, -30,
-     -30, -40, -40, -30, -30, -20, -30, -40, -40, -50, -50, -40, -40,
-     -30, -30, -40, -40, -50, -50, -40, -40, -30, -30, -40, -40, -50,
-     -50, -40, -40, -30, -30, -40, -40, -50, -50, -40, -40, -30},
-    {
-        -30, -40, -40, -50, -50, -40, -40, -30, -30, -40, -40, -50, -50,
-        -40, -40, -30, -30, -40, -40, -50, -50, -40, -40, -30, -30, -40,
-        -40, -50, -50, -40, -40, -30, -20, -30, -30, -40, -40, -30, -30,
-        -20, -10, -20, -20, -20, -20, -20, -20, -10, 20,  20,  0,   0,
-        0,   0,   20,  20,  20,  30,  10,  0,   0,   10,  30,  20,
-    }};
+// Endgame Piece-Square Tables:
+const int8_t Evaluation::eg_piece_square_tables[6][64] = {
+    {// PAWN, the further advanced the better
+     0,  0,  0,  0,  0,  0,  0,  0,  //
+     80, 80, 80, 80, 80, 80, 80, 80, //
+     50, 50, 50, 50, 50, 50, 50, 50, //
+     30, 30, 30, 30, 30, 30, 30, 30, //
+     15, 15, 15, 15, 15, 15, 15, 15, //
+     5,  5,  5,  5,  5,  5,  5,  5,  //
+     0,  0,  0,  0,  0,  0,  0,  0,  //
+     0,  0,  0,  0,  0,  0,  0,  0},
+    {// KNIGHT
+     -50, -40, -30, -30, -30, -30, -40, -50, //
+     -40, -20, 0,   0,   0,   0,   -20, -40, //
+     -30, 0,   10,  15,  15,  10,  0,   -30, //
+     -30, 0,   15,  20,  20,  15,  0,   -30, //
+     -30, 0,   15,  20,  20,  15,  0,   -30, //
+     -30, 0,   10,  15,  15,  10,  0,   -30, //
+     -40, -20, 0,   0,   0,   0,   -20, -40, //
+     -50, -40, -30, -30, -30, -30, -40, -50},
+    {// BISHOP
+     -20, -10, -10, -10, -10, -10, -10, -20, //
+     -10, 0,   0,   0,   0,   0,   0,   -10, //
+     -10, 0,   5,   10,  10,  5,   0,   -10, //
+     -10, 0,   10,  15,  15,  10,  0,   -10, //
+     -10, 0,   10,  15,  15,  10,  0,   -10, //
+     -10, 0,   5,   10,  10,  5,   0,   -10, //
+     -10, 0,   0,   0,   0,   0,   0,   -10, //
+     -20, -10, -10, -10, -10, -10, -10, -20},
+    {// ROOK
+     0,  0,  0,  0,  0,  0,  0,  0,  //
+     10, 10, 10, 10, 10, 10, 10, 10, //
+     0,  0,  0,  0,  0,  0,  0,  0,  //
+     0,  0,  0,  0,  0,  0,  0,  0,  //
+     0,  0,  0,  0,  0,  0,  0,  0,  //
+     0,  0,  0,  0,  0,  0,  0,  0,  //
+     0,  0,  0,  0,  0,  0,  0,  0,  //
+     0,  0,  0,  0,  0,  0,  0,  0},
+    {// QUEEN
+     -20, -10, -10, -5, -5, -10, -10, -20, //
+     -10, 0,   0,   0,  0,  0,   0,   -10, //
+     -10, 0,   5,   5,  5,  5,   0,   -10, //
+     -5,  0,   5,   10, 10, 5,   0,   -5,  //
+     -5,  0,   5,   10, 10, 5,   0,   -5,  //
+     -10, 0,   5,   5,  5,  5,   0,   -10, //
+     -10, 0,   0,   0,  0,  0,   0,   -10, //
+     -20, -10, -10, -5, -5, -10, -10, -20},
+    {// KING, in the centre where it supports its pawns
+     -50, -40, -30, -20, -20, -30, -40, -50, //
+     -30, -20, -10, 0,   0,   -10, -20, -30, //
+     -30, -10, 20,  30,  30,  20,  -10, -30, //
+     -30, -10, 30,  40,  40,  30,  -10, -30, //
+     -30, -10, 30,  40,  40,  30,  -10, -30, //
+     -30, -10, 20,  30,  30,  20,  -10, -30, //
+     -30, -30, 0,   0,   0,   0,   -30, -30, //
+     -50, -30, -30, -30, -30, -30, -30, -50}};
 
 #endif
@@ -2,12 +2,16 @@
  * Evaluation class.
  * Contains the evaluate_position function, which determines white's chances of
  * winning for a given position.
+ * Material and piece-square terms come in midgame and endgame pairs, blended
+ * by the game phase, the non-pawn material left on the board.
+ * Pawn structure terms are cached in a pawn table by the pawn zobrist key.
  */
 
 #ifndef EVALUATION_HPP // GUARD
 #define EVALUATION_HPP // GUARD
 
 #include "Board.hpp"
+#include "PawnTable.hpp"
 #include <stdint.h>
 
 typedef bitboard uint64_t;
@@ -20,22 +24,73 @@ public:
   // Evaluate:
   int evaluate(Board &board);
 
-private:
-  // Helpers:
-  int count_set_bits(bitboard positions);
+  /*
+   * Empties the pawn table.
+   */
+  inline void clear() { pawn_table.clear(); }
 
-  // Piece Values:
+  // Piece Values, used by search for pruning margins and by Board for static
+  // exchange evaluation:
   static const uint16_t piece_values[6];
 
-  // Piece-Square Tables:
-  static const int8_t pawn_square_table[2][64];
-  static const int8_t knight_square_table[2][64];
-  static const int8_t bishop_square_table[2][64];
-  static const int8_t rook_square_table[2][64];
-  static const int8_t queen_square_table[2][64];
-  static const int8_t king_square_table[2][64];
+  // Tapered Piece Values and Piece-Square Tables, summed incrementally by
+  // Board. The tables are from white's point of view, a8 first and h1 last:
+  static const int16_t mg_piece_values[6];
+  static const int16_t eg_piece_values[6];
+  static const int8_t mg_piece_square_tables[6][64];
+  static const int8_t eg_piece_square_tables[6][64];
+
+  // Game Phase, also kept incrementally by Board:
+  static const int phase_weights[6];
+  static const int MAX_PHASE = 24; // all pieces on the board
+
+  /*
+   * A midgame and an endgame score packed into one int, so that Board sums
+   * both with a single addition.
+   */
+  static inline int make_score(int mg, int eg) { return mg * (1 << 16) + eg; }
+  static inline int get_mg_score(int score) {
+    return (int16_t)((unsigned)(score + 0x8000) >> 16);
+  }
+  static inline int get_eg_score(int score) {
+    return (int16_t)(score & 0xFFFF);
+  }
+
+  // Pawn Structure:
+  /*
+   * Returns the pawn table entry for the board's pawns, evaluating them and
+   * storing the result if the table does not have them.
+   */
+  PawnEntry &probe_pawn_table(Board &board);
+  /*
+   * Packed score of the doubled, isolated, backward, passed and connected
+   * pawns of both colors, from white's point of view. Sets passed_pawns.
+   */
+  static int evaluate_pawns(Board &board, bitboard passed_pawns[2]);
+  /*
+   * Packed midgame score of the pawns in front of color's king on its file
+   * and the files beside it. The king is not in the pawn key, so this is
+   * not cached.
+   */
+  static int evaluate_shelter(Board &board, Color color);
 
-  static const int8_t piece_square_tables[2][6][64];
+private:
+  PawnTable pawn_table;
+
+  // Pawn Structure Scores, packed:
+  static const int doubled_pawn_score;
+  static const int isolated_pawn_score;
+  static const int backward_pawn_score;
+  static const int connected_pawn_score;
+  static const int passed_pawn_scores[8]; // by rank from the pawn's side
+  static const int shelter_pawn_scores[3]; // pawn one, two or no rank ahead
+
+  // Helpers:
+  static bitboard get_front_span(Color color, int square_index,
+                                 bitboard files);
+  static inline bitboard get_adjacent_files(bitboard file) {
+    return ((file << 1) & ~FILE_H) | ((file >> 1) & ~FILE_A);
+  }
 };
 
 #endif // GUARD
@@ -26,7 +26,9 @@ Move::Move(bitboard origin, bitboard destination, char flag) {
   set_flag(flag);
 }
 
-Move::Move() {}
+Move::Move() { move_rep = 0; }
+
+Move::Move(uint16_t move_rep) { this->move_rep = move_rep; }
 
 // Getters:
 bool Move::is_double_pawn_push() { return get_flags() == 1; }
@@ -119,35 +121,20 @@ bool Move::move_equals(Move &other_move) {
 }
 
 // Helpers:
+// Square index = row * 8 + (7 - col), since bit 0 is h1 and bit 7 is a1.
 bitboard Move::get_position_from_row_col(uint8_t row, uint8_t col) {
-  bitboard position = 1;
-
-  for (char row_index = 0; row_index < row; row_index++) {
-    position <<= 8;
-  }
-
-  for (char col_index = 7; col_index > col; col_index--) {
-    position <<= 1;
-  }
-
-  return position;
+  return ((bitboard)1) << (((row & 7) << 3) + ((7 - col) & 7));
 }
 
 std::string Move::get_row_col_from_position(bitboard position) {
-  std::array<char, 8> letters = {'a', 'b', 'c', 'd', 'e', 'f', 'g', 'h'};
-  std::string row_col = "00";
-  bitboard mask = 1;
-  for (int row = 0; row <= 7; row++) {
-    for (int col = 7; col >= 0; col--) {
-      if (mask & position) {
-        row_col[0] = col + 'a';
-        row_col[1] = row + '1';
-        return row_col;
-      }
-      mask <<= 1;
-    }
+  if (!position) {
+    return "00";
   }
-  return "00";
+  int square_index = lsb(position);
+  std::string row_col = "00";
+  row_col[0] = 'h' - (square_index & 7);
+  row_col[1] = '1' + (square_index >> 3);
+  return row_col;
 }
 
 #endif // GUARD
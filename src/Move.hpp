@@ -48,14 +48,19 @@ public:
        char flag);
   Move(bitboard origin, bitboard destination, char flag);
   Move();
+  // From the 16 bit representation returned by get_move_rep.
+  explicit Move(uint16_t move_rep);
 
   // Getters:
+  inline uint16_t get_move_rep() { return move_rep; }
   inline bitboard get_origin() {
     return ((bitboard)1) << ((move_rep & 0xFC00) >> 10);
   }
   inline bitboard get_destination() {
     return ((bitboard)1) << ((move_rep & 0x3F0) >> 4);
   }
+  inline unsigned get_origin_index() { return (move_rep & 0xFC00) >> 10; }
+  inline unsigned get_destination_index() { return (move_rep & 0x3F0) >> 4; }
   inline bitboard get_flags() { return move_rep & 0xF; }
   bool is_double_pawn_push();
   bool is_null();
@@ -64,6 +69,8 @@ public:
     return get_flags() == 4 || get_flags() == 5 ||
            (get_flags() >= 12 && get_flags() <= 15);
   }
+  // Neither a capture nor a queen promotion.
+  inline bool is_quiet() { return !is_capture() && get_flags() != 11; }
 
   // Setters:
   inline void set_origin(bitboard origin) {
@@ -3,23 +3,205 @@
 
 #include "MoveGenerator.hpp"
 #include "MoveList.hpp"
+#include <assert.h>
 
 MoveGenerator::MoveGenerator() {}
 
-MoveList MoveGenerator::generate_legal_moves(Board &board, Color color) {
+/*
+ * Generates only legal moves of the requested class.
+ * Checkers and pinned pieces are computed once per position. When in check,
+ * non-king moves must capture the checker or block the check; pinned pieces
+ * may only move along the line through their king; king moves and en passant
+ * captures are verified against the occupancy they leave behind.
+ */
+MoveList MoveGenerator::generate_legal_moves(Board &board, Color color,
+                                             GenerationMode::Value mode) {
   MoveList legal_moves;
 
-  MoveList pseudo_legal_moves = generate_pseudo_legal_moves(board, color);
-  for (int i = 0; i < pseudo_legal_moves.size(); i++) {
-    if (pseudo_legal_moves[i].is_castle() ||
-        board.is_move_legal(pseudo_legal_moves[i], color)) {
-      legal_moves.add_move(pseudo_legal_moves[i]);
-    }
+  bitboard king_position = board.get_piece_positions(KING, color);
+  assert(king_position);
+  bitboard checkers = board.get_checkers(color);
+  assert(mode != GenerationMode::Value::EVASIONS || checkers);
+  if (checkers & (checkers - 1)) { // double check: only the king can move
+    add_legal_king_moves(board, color, mode, legal_moves);
+    return legal_moves;
+  }
+
+  bitboard check_mask = ~(bitboard)0;
+  if (checkers) {
+    check_mask = checkers | board.get_squares_between(king_position, checkers);
+  }
+  bitboard pinned = board.get_pinned_pieces(color);
+
+  add_legal_pawn_moves(board, color, check_mask, pinned, mode, legal_moves);
+  add_legal_piece_moves(board, color, KNIGHT, check_mask, pinned, mode,
+                        legal_moves);
+  add_legal_piece_moves(board, color, BISHOP, check_mask, pinned, mode,
+                        legal_moves);
+  add_legal_piece_moves(board, color, ROOK, check_mask, pinned, mode,
+                        legal_moves);
+  add_legal_piece_moves(board, color, QUEEN, check_mask, pinned, mode,
+                        legal_moves);
+  add_legal_king_moves(board, color, mode, legal_moves);
+
+  if (!checkers && mode != GenerationMode::Value::CAPTURES) {
+    add_legal_castle_moves(board, color, legal_moves);
   }
 
   return legal_moves;
 }
 
+void MoveGenerator::add_legal_pawn_moves(Board &board, Color color,
+                                         bitboard check_mask, bitboard pinned,
+                                         GenerationMode::Value mode,
+                                         MoveList &moves) {
+  add_pawn_moves(board, color, check_mask, pinned, mode, moves);
+  if (mode != GenerationMode::Value::QUIETS) {
+    add_legal_en_passant_moves(board, color, moves);
+  }
+}
+
+void MoveGenerator::add_legal_piece_moves(Board &board, Color color,
+                                          Piece piece, bitboard check_mask,
+                                          bitboard pinned,
+                                          GenerationMode::Value mode,
+                                          MoveList &moves) {
+  add_piece_moves(board, color, piece, check_mask, pinned, mode, moves);
+}
+
+void MoveGenerator::add_legal_king_moves(Board &board, Color color,
+                                         GenerationMode::Value mode,
+                                         MoveList &moves) {
+  Color other_color = negate_color(color);
+  bitboard king_position = board.get_piece_positions(KING, color);
+  bitboard other_pieces = board.get_all_piece_positions(color);
+  bitboard opposing_pieces = board.get_all_piece_positions(other_color);
+  // the king must not hide behind itself from a slider
+  bitboard occupancy = (other_pieces | opposing_pieces) & ~king_position;
+
+  bitboard destination_squares =
+      board.get_piece_attacks(KING, king_position, color) & ~other_pieces;
+  if (mode == GenerationMode::Value::CAPTURES) {
+    destination_squares &= opposing_pieces;
+  } else if (mode == GenerationMode::Value::QUIETS) {
+    destination_squares &= ~opposing_pieces;
+  }
+  while (destination_squares) {
+    bitboard destination = pop_lsb(destination_squares);
+    if (!board.get_attackers(destination, other_color, occupancy)) {
+      Move move(king_position, destination,
+                (destination & opposing_pieces) ? 4 : 0);
+      moves.add_move(move);
+    }
+  }
+}
+
+void MoveGenerator::add_legal_en_passant_moves(Board &board, Color color,
+                                               MoveList &moves) {
+  MoveList en_passant_moves;
+  add_pseudo_legal_en_passant_moves(board, color, en_passant_moves);
+  for (int i = 0; i < en_passant_moves.size(); i++) {
+    if (is_en_passant_legal(board, color, en_passant_moves[i])) {
+      moves.add_move(en_passant_moves[i]);
+    }
+  }
+}
+
+// Validation:
+/*
+ * Returns true if move could have been produced by the pseudo-legal generator
+ * in the current position. Only the moves of the moving piece that land on the
+ * move's destination are generated to check this.
+ */
+bool MoveGenerator::is_pseudo_legal(Board &board, Color color, Move &move) {
+  if (move.is_null()) {
+    return false;
+  }
+  bitboard origin = move.get_origin();
+  if (!(origin & board.get_all_piece_positions(color))) {
+    return false;
+  }
+
+  MoveList candidates;
+  bitboard destination = move.get_destination();
+  Piece piece = board.get_piece_at_position(origin, color);
+  if (move.is_castle()) {
+    add_legal_castle_moves(board, color, candidates);
+  } else if (move.get_flags() == 5) {
+    add_pseudo_legal_en_passant_moves(board, color, candidates);
+  } else if (piece == PAWN) {
+    add_pawn_moves(board, color, destination, 0, GenerationMode::Value::ALL,
+                   candidates);
+  } else {
+    add_piece_moves(board, color, piece, destination, 0,
+                    GenerationMode::Value::ALL, candidates);
+  }
+
+  for (int i = 0; i < candidates.size(); i++) {
+    if (candidates[i].move_equals(move)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/*
+ * Returns true if the pseudo-legal move does not leave the king in check.
+ * checkers and pinned must be Board::get_checkers and
+ * Board::get_pinned_pieces for the current position.
+ */
+bool MoveGenerator::is_legal(Board &board, Color color, Move &move,
+                             bitboard checkers, bitboard pinned) {
+  if (move.is_castle()) { // castle moves are only generated when legal
+    return true;
+  }
+
+  bitboard king_position = board.get_piece_positions(KING, color);
+  bitboard origin = move.get_origin();
+  bitboard destination = move.get_destination();
+
+  if (origin == king_position) {
+    bitboard occupancy = (board.get_all_piece_positions(WHITE) |
+                          board.get_all_piece_positions(BLACK)) &
+                         ~king_position;
+    return !board.get_attackers(destination, negate_color(color), occupancy);
+  }
+  if (checkers & (checkers - 1)) {
+    return false;
+  }
+  if (move.get_flags() == 5) {
+    return is_en_passant_legal(board, color, move);
+  }
+  if (checkers &&
+      !(destination &
+        (checkers | board.get_squares_between(king_position, checkers)))) {
+    return false;
+  }
+  if ((origin & pinned) &&
+      !(destination & board.get_line_through(king_position, origin))) {
+    return false;
+  }
+  return true;
+}
+
+/*
+ * En passant removes two pieces from the capturing rank, so check the
+ * resulting occupancy directly instead of relying on pin and check masks.
+ */
+bool MoveGenerator::is_en_passant_legal(Board &board, Color color,
+                                        Move &move) {
+  Color other_color = negate_color(color);
+  bitboard king_position = board.get_piece_positions(KING, color);
+  bitboard occupancy = board.get_all_piece_positions(color) |
+                       board.get_all_piece_positions(other_color);
+  bitboard origin = move.get_origin();
+  bitboard destination = move.get_destination();
+  bitboard captured = color == WHITE ? south(destination) : north(destination);
+  bitboard new_occupancy = (occupancy ^ origin ^ captured) | destination;
+  return !(board.get_attackers(king_position, other_color, new_occupancy) &
+           ~captured);
+}
+
 MoveList MoveGenerator::generate_pseudo_legal_moves(Board &board, Color color) {
   MoveList pseudo_legal_moves;
   add_pseudo_legal_pawn_moves(board, color, pseudo_legal_moves);
@@ -34,63 +216,41 @@ MoveList MoveGenerator::generate_pseudo_legal_moves(Board &board, Color color) {
   return pseudo_legal_moves;
 }
 
-void MoveGenerator::add_pseudo_legal_pawn_moves(Board &board, Color color,
-                                                MoveList &moves) {
-  bitboard promotion_file = color == WHITE ? RANK_8 : RANK_1;
-
-  bitboard moving_pawns = board.get_piece_positions(PAWN, color);
-  bitboard other_pieces = board.get_all_piece_positions(color);
-  bitboard opposing_pieces = board.get_all_piece_positions(negate_color(color));
-
-  while (moving_pawns) {
-    bitboard current_position = pop_lsb(moving_pawns);
-    bitboard single_push_squares =
-        board.get_pawn_single_push(current_position, color) & ~opposing_pieces &
-        ~other_pieces;
-
-    bitboard quiet_single_push_squares = single_push_squares & ~promotion_file;
-    add_moves(current_position, quiet_single_push_squares, 0, moves);
-
-    bitboard promotion_push_squares = single_push_squares & promotion_file;
-    add_promotion_moves(current_position, promotion_push_squares, false, moves);
-
-    bitboard double_push_squares =
-        board.get_pawn_double_push(current_position, color) & ~opposing_pieces &
-        ~other_pieces &
-        (color == WHITE ? single_push_squares << 8 : single_push_squares >> 8);
-    add_moves(current_position, double_push_squares, 1, moves);
-
-    bitboard capture_squares =
-        board.get_piece_attacks(PAWN, current_position, color) &
-        opposing_pieces;
-
-    bitboard normal_capture_squares = capture_squares & ~promotion_file;
-    add_moves(current_position, normal_capture_squares, 4, moves);
+// Captures (including en passant) and queen promotions.
+void MoveGenerator::add_pseudo_legal_captures(Board &board, Color color,
+                                              MoveList &moves) {
+  add_pawn_moves(board, color, ~(bitboard)0, 0,
+                 GenerationMode::Value::CAPTURES, moves);
+  add_pseudo_legal_en_passant_moves(board, color, moves);
+  for (Piece piece = KNIGHT; piece <= KING; piece = (Piece)(piece + 1)) {
+    add_piece_moves(board, color, piece, ~(bitboard)0, 0,
+                    GenerationMode::Value::CAPTURES, moves);
+  }
+}
 
-    bitboard promotion_capture_squares = capture_squares & promotion_file;
-    add_promotion_moves(current_position, promotion_capture_squares, true,
-                        moves);
+// Everything add_pseudo_legal_captures leaves out, including castles.
+void MoveGenerator::add_pseudo_legal_quiets(Board &board, Color color,
+                                            MoveList &moves) {
+  add_pawn_moves(board, color, ~(bitboard)0, 0, GenerationMode::Value::QUIETS,
+                 moves);
+  for (Piece piece = KNIGHT; piece <= KING; piece = (Piece)(piece + 1)) {
+    add_piece_moves(board, color, piece, ~(bitboard)0, 0,
+                    GenerationMode::Value::QUIETS, moves);
   }
+  add_legal_castle_moves(board, color, moves);
+}
 
+void MoveGenerator::add_pseudo_legal_pawn_moves(Board &board, Color color,
+                                                MoveList &moves) {
+  add_pawn_moves(board, color, ~(bitboard)0, 0, GenerationMode::Value::ALL,
+                 moves);
   add_pseudo_legal_en_passant_moves(board, color, moves);
 }
 
 void MoveGenerator::add_pseudo_legal_piece_moves(Board &board, Color color,
                                                  Piece piece, MoveList &moves) {
-  bitboard moving_pieces = board.get_piece_positions(piece, color);
-  bitboard other_pieces = board.get_all_piece_positions(color);
-  bitboard opposing_pieces = board.get_all_piece_positions(negate_color(color));
-
-  while (moving_pieces) {
-    bitboard current_position = pop_lsb(moving_pieces);
-    bitboard destination_squares =
-        board.get_piece_attacks(piece, current_position, color) & ~other_pieces;
-    bitboard quiet_squares = destination_squares & ~opposing_pieces;
-
-    add_moves(current_position, quiet_squares, 0, moves);
-    bitboard capture_squares = destination_squares & opposing_pieces;
-    add_moves(current_position, capture_squares, 4, moves);
-  }
+  add_piece_moves(board, color, piece, ~(bitboard)0, 0,
+                  GenerationMode::Value::ALL, moves);
 }
 
 void MoveGenerator::add_pseudo_legal_en_passant_moves(Board &board, Color color,
@@ -223,6 +383,108 @@ void MoveGenerator::add_legal_queenside_castle_move(Board &board, Color color,
   moves.add_move(queen_side_castle_move);
 }
 
+/*
+ * Adds the pawn pushes, captures and promotions (but not en passant) of the
+ * given generation mode whose destination lies in target_mask. Pinned pawns
+ * are restricted to the line through their king.
+ */
+void MoveGenerator::add_pawn_moves(Board &board, Color color,
+                                   bitboard target_mask, bitboard pinned,
+                                   GenerationMode::Value mode,
+                                   MoveList &moves) {
+  bitboard promotion_file = color == WHITE ? RANK_8 : RANK_1;
+
+  bitboard king_position = board.get_piece_positions(KING, color);
+  bitboard moving_pawns = board.get_piece_positions(PAWN, color);
+  bitboard other_pieces = board.get_all_piece_positions(color);
+  bitboard opposing_pieces = board.get_all_piece_positions(negate_color(color));
+
+  bool add_quiets = mode != GenerationMode::Value::CAPTURES;
+  bool add_captures = mode != GenerationMode::Value::QUIETS;
+
+  while (moving_pawns) {
+    bitboard current_position = pop_lsb(moving_pawns);
+    bitboard legal_squares = target_mask;
+    if (current_position & pinned) {
+      legal_squares &= board.get_line_through(king_position, current_position);
+    }
+
+    bitboard single_push_squares =
+        board.get_pawn_single_push(current_position, color) & ~opposing_pieces &
+        ~other_pieces;
+
+    if (add_quiets) {
+      bitboard quiet_single_push_squares =
+          single_push_squares & ~promotion_file & legal_squares;
+      add_moves(current_position, quiet_single_push_squares, 0, moves);
+    }
+
+    // queen promotions count as captures, under-promotions as quiets
+    bitboard promotion_push_squares =
+        single_push_squares & promotion_file & legal_squares;
+    add_promotion_moves(current_position, promotion_push_squares, false, mode,
+                        moves);
+
+    if (add_quiets) {
+      bitboard double_push_squares =
+          board.get_pawn_double_push(current_position, color) &
+          ~opposing_pieces & ~other_pieces &
+          (color == WHITE ? single_push_squares << 8
+                          : single_push_squares >> 8) &
+          legal_squares;
+      add_moves(current_position, double_push_squares, 1, moves);
+    }
+
+    if (add_captures) {
+      bitboard capture_squares =
+          board.get_piece_attacks(PAWN, current_position, color) &
+          opposing_pieces & legal_squares;
+
+      bitboard normal_capture_squares = capture_squares & ~promotion_file;
+      add_moves(current_position, normal_capture_squares, 4, moves);
+
+      bitboard promotion_capture_squares = capture_squares & promotion_file;
+      add_promotion_moves(current_position, promotion_capture_squares, true,
+                          moves);
+    }
+  }
+}
+
+/*
+ * Adds the knight, bishop, rook, queen or king moves of the given generation
+ * mode whose destination lies in target_mask. Pinned pieces are restricted to
+ * the line through their king.
+ */
+void MoveGenerator::add_piece_moves(Board &board, Color color, Piece piece,
+                                    bitboard target_mask, bitboard pinned,
+                                    GenerationMode::Value mode,
+                                    MoveList &moves) {
+  bitboard king_position = board.get_piece_positions(KING, color);
+  bitboard moving_pieces = board.get_piece_positions(piece, color);
+  bitboard other_pieces = board.get_all_piece_positions(color);
+  bitboard opposing_pieces = board.get_all_piece_positions(negate_color(color));
+
+  while (moving_pieces) {
+    bitboard current_position = pop_lsb(moving_pieces);
+    bitboard destination_squares =
+        board.get_piece_attacks(piece, current_position, color) &
+        ~other_pieces & target_mask;
+    if (current_position & pinned) {
+      destination_squares &=
+          board.get_line_through(king_position, current_position);
+    }
+
+    if (mode != GenerationMode::Value::CAPTURES) {
+      bitboard quiet_squares = destination_squares & ~opposing_pieces;
+      add_moves(current_position, quiet_squares, 0, moves);
+    }
+    if (mode != GenerationMode::Value::QUIETS) {
+      bitboard capture_squares = destination_squares & opposing_pieces;
+      add_moves(current_position, capture_squares, 4, moves);
+    }
+  }
+}
+
 void MoveGenerator::add_moves(bitboard origin, bitboard all_destinations,
                               char flag, MoveList &moves) {
   while (all_destinations) {
@@ -245,6 +507,26 @@ void MoveGenerator::add_promotion_moves(bitboard origin,
   }
 }
 
+void MoveGenerator::add_promotion_moves(bitboard origin,
+                                        bitboard all_destinations, bool capture,
+                                        GenerationMode::Value mode,
+                                        MoveList &moves) {
+  if (mode == GenerationMode::Value::CAPTURES) { // queen promotion only
+    add_moves(origin, all_destinations, capture ? 15 : 11, moves);
+  } else if (mode == GenerationMode::Value::QUIETS) { // under-promotions only
+    int start_flag = capture ? 12 : 8;
+    while (all_destinations) {
+      bitboard current_destination = pop_lsb(all_destinations);
+      for (int i = 0; i < 3; i++) {
+        Move move(origin, current_destination, start_flag + i);
+        moves.add_move(move);
+      }
+    }
+  } else {
+    add_promotion_moves(origin, all_destinations, capture, moves);
+  }
+}
+
 uint64_t MoveGenerator::perft(int depth, Board &board, Color color) {
   uint64_t nodes = 0;
 
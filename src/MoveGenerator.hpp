@@ -12,13 +12,40 @@
 
 #include <array>
 
+/*
+ * Which class of moves to generate.
+ * CAPTURES and QUIETS partition ALL: CAPTURES holds every capture plus
+ * non-capture queen promotions, QUIETS holds everything else. EVASIONS is
+ * only valid when the side to move is in check and holds every legal move.
+ */
+namespace GenerationMode {
+enum Value { ALL = 0, CAPTURES = 1, QUIETS = 2, EVASIONS = 3 };
+};
+
 class MoveGenerator {
 public:
   // Constructor:
   MoveGenerator();
 
   // Generate legal moves:
-  MoveList generate_legal_moves(Board &board, Color color);
+  MoveList generate_legal_moves(
+      Board &board, Color color,
+      GenerationMode::Value mode = GenerationMode::Value::ALL);
+  void add_legal_pawn_moves(Board &board, Color color, bitboard check_mask,
+                            bitboard pinned, GenerationMode::Value mode,
+                            MoveList &moves);
+  void add_legal_piece_moves(Board &board, Color color, Piece piece,
+                             bitboard check_mask, bitboard pinned,
+                             GenerationMode::Value mode, MoveList &moves);
+  void add_legal_king_moves(Board &board, Color color,
+                            GenerationMode::Value mode, MoveList &moves);
+  void add_legal_en_passant_moves(Board &board, Color color, MoveList &moves);
+
+  // Validation (for moves that were not generated, e.g. hash moves):
+  bool is_pseudo_legal(Board &board, Color color, Move &move);
+  bool is_legal(Board &board, Color color, Move &move, bitboard checkers,
+                bitboard pinned);
+  bool is_en_passant_legal(Board &board, Color color, Move &move);
 
   // Pseudo-legal moves:
   MoveList generate_pseudo_legal_moves(Board &board, Color color);
@@ -34,6 +61,8 @@ public:
                                     MoveList &moves);
   void add_pseudo_legal_en_passant_moves(Board &board, Color color,
                                          MoveList &moves);
+  void add_pseudo_legal_captures(Board &board, Color color, MoveList &moves);
+  void add_pseudo_legal_quiets(Board &board, Color color, MoveList &moves);
 
   void add_legal_castle_moves(Board &board, Color color, MoveList &moves);
   void add_legal_kingside_castle_move(Board &board, Color color,
@@ -51,10 +80,19 @@ public:
   void add_castle_moves();            // TODO: parameters
 
   // Helpers:
+  void add_pawn_moves(Board &board, Color color, bitboard target_mask,
+                      bitboard pinned, GenerationMode::Value mode,
+                      MoveList &moves);
+  void add_piece_moves(Board &board, Color color, Piece piece,
+                       bitboard target_mask, bitboard pinned,
+                       GenerationMode::Value mode, MoveList &moves);
   void add_moves(bitboard origin, bitboard all_destinations, char flag,
                  MoveList &moves);
   void add_promotion_moves(bitboard origin, bitboard all_destinations,
                            bool capture, MoveList &moves);
+  void add_promotion_moves(bitboard origin, bitboard all_destinations,
+                           bool capture, GenerationMode::Value mode,
+                           MoveList &moves);
 
   // Debug:
   uint64_t perft(int depth, Board &board, Color color);
@@ -3,6 +3,20 @@
 
 #include "MoveList.hpp"
 
+#include <algorithm>
+
 MoveList::MoveList() { count = 0; }
 
+Move &ScoredMoveList::pick_best(size_t index) {
+  size_t best_index = index;
+  for (size_t i = index + 1; i < count; i++) {
+    if (scores[i] > scores[best_index]) {
+      best_index = i;
+    }
+  }
+  std::swap(moves[index], moves[best_index]);
+  std::swap(scores[index], scores[best_index]);
+  return moves[index];
+}
+
 #endif
@@ -22,4 +22,24 @@ public:
   Move &operator[](size_t i) { return moves[i]; }
 };
 
+/*
+ * Array of moves with an ordering score per move.
+ * Moves are handed out best score first by selecting the best remaining move
+ * on each call, so a node which cuts off early never pays for a full sort.
+ */
+class ScoredMoveList : public MoveList {
+public:
+  int scores[256];
+
+  inline void add_move(Move move, int score) {
+    scores[count] = score;
+    moves[count++] = move;
+  }
+
+  /*
+   * Swaps the best scoring move at or after index into index and returns it.
+   */
+  Move &pick_best(size_t index);
+};
+
 #endif
@@ -0,0 +1,152 @@
+#ifndef MOVE_PICKER_CPP // GUARD
+#define MOVE_PICKER_CPP // GUARD
+
+#include "MovePicker.hpp"
+
+// Constructor:
+MovePicker::MovePicker(Board &board, MoveGenerator &move_gen, Move tt_move,
+                       Move killer_one, Move killer_two, Move counter_move,
+                       const int (*history)[64])
+    : board(board), move_gen(move_gen), tt_move(tt_move),
+      counter_move(counter_move), history(history) {
+  color = board.get_turn_color();
+  checkers = board.get_checkers(color);
+  pinned = board.get_pinned_pieces(color);
+  stage = TT_MOVE;
+  killers[0] = killer_one;
+  killers[1] = killer_two;
+  killer_index = 0;
+  move_index = 0;
+  bad_capture_index = 0;
+}
+
+Move MovePicker::next_move() {
+  switch (stage) {
+  case TT_MOVE:
+    stage = GENERATE_CAPTURES;
+    if (move_gen.is_pseudo_legal(board, color, tt_move) && is_legal(tt_move)) {
+      return tt_move;
+    }
+    // fall through
+  case GENERATE_CAPTURES:
+    move_gen.add_pseudo_legal_captures(board, color, moves);
+    score_captures();
+    move_index = 0;
+    stage = CAPTURES;
+    // fall through
+  case CAPTURES:
+    while (move_index < moves.size()) {
+      Move &move = moves.pick_best(move_index++);
+      if (move.move_equals(tt_move) || !is_legal(move)) {
+        continue;
+      }
+      if (!board.see_ge(move, 0)) { // loses material, try after the quiets
+        bad_captures.add_move(move);
+        continue;
+      }
+      return move;
+    }
+    stage = KILLERS;
+    // fall through
+  case KILLERS:
+    while (killer_index < 2) {
+      Move &killer = killers[killer_index++];
+      if (killer_index == 2 && killer.move_equals(killers[0])) {
+        continue;
+      }
+      if (!killer.move_equals(tt_move) && is_valid_quiet(killer)) {
+        return killer;
+      }
+    }
+    stage = COUNTER_MOVE;
+    // fall through
+  case COUNTER_MOVE:
+    stage = GENERATE_QUIETS;
+    if (!counter_move.move_equals(tt_move) &&
+        !counter_move.move_equals(killers[0]) &&
+        !counter_move.move_equals(killers[1]) && is_valid_quiet(counter_move)) {
+      return counter_move;
+    }
+    // fall through
+  case GENERATE_QUIETS:
+    moves.count = 0;
+    move_gen.add_pseudo_legal_quiets(board, color, moves);
+    score_quiets();
+    move_index = 0;
+    stage = QUIETS;
+    // fall through
+  case QUIETS:
+    while (move_index < moves.size()) {
+      Move &move = moves.pick_best(move_index++);
+      if (!is_already_tried(move) && is_legal(move)) {
+        return move;
+      }
+    }
+    stage = BAD_CAPTURES;
+    // fall through
+  case BAD_CAPTURES:
+    if (bad_capture_index < bad_captures.size()) {
+      return bad_captures[bad_capture_index++];
+    }
+    stage = DONE;
+    // fall through
+  case DONE:
+    return Move();
+  }
+  return Move();
+}
+
+int MovePicker::score_capture(Board &board, Move &move) {
+  Color color = board.get_turn_color();
+  Piece attacker = board.get_piece_at_position(move.get_origin(), color);
+  Piece victim = move.get_flags() == 5
+                     ? PAWN
+                     : board.get_piece_at_position(move.get_destination(),
+                                                   negate_color(color));
+  if (victim == NONE) { // queen promotion
+    victim = QUEEN;
+  }
+  return victim_aggressor_values[victim][attacker];
+}
+
+const uint8_t MovePicker::victim_aggressor_values[6][6] = {
+    {15, 14, 13, 12, 11, 10}, // victim P, attacker P, N, B, R, Q, K
+    {25, 24, 23, 22, 21, 20}, // victim N, attacker P, N, B, R, Q, K
+    {35, 34, 33, 32, 31, 30}, // victim B, attacker P, N, B, R, Q, K
+    {45, 44, 43, 42, 41, 40}, // victim R, attacker P, N, B, R, Q, K
+    {55, 54, 53, 52, 51, 50}, // victim Q, attacker P, N, B, R, Q, K
+    {0, 0, 0, 0, 0, 0}        // victim K, attacker P, N, B, R, Q, K
+};
+
+// Helpers:
+void MovePicker::score_captures() {
+  for (size_t i = 0; i < moves.size(); i++) {
+    moves.scores[i] = score_capture(board, moves[i]);
+  }
+}
+
+void MovePicker::score_quiets() {
+  for (size_t i = 0; i < moves.size(); i++) {
+    moves.scores[i] =
+        history ? history[moves[i].get_origin_index()]
+                         [moves[i].get_destination_index()]
+                : 0;
+  }
+}
+
+// Whether a move from outside the generator is a legal quiet move here.
+bool MovePicker::is_valid_quiet(Move &move) {
+  return move.is_quiet() && move_gen.is_pseudo_legal(board, color, move) &&
+         is_legal(move);
+}
+
+bool MovePicker::is_already_tried(Move &move) {
+  return move.move_equals(tt_move) || move.move_equals(killers[0]) ||
+         move.move_equals(killers[1]) || move.move_equals(counter_move);
+}
+
+bool MovePicker::is_legal(Move &move) {
+  return move_gen.is_legal(board, color, move, checkers, pinned);
+}
+
+#endif // GUARD
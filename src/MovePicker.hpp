@@ -0,0 +1,86 @@
+/*
+ * MovePicker class.
+ * Hands out the moves of a position one at a time, in stages, so that a
+ * search node which cuts off early never generates the moves it does not try:
+ * 1. the hash move, validated rather than generated
+ * 2. captures which do not lose material, most valuable victim first
+ * 3. killer moves, validated rather than generated
+ * 4. the counter move to the opponent's last move, validated likewise
+ * 5. the remaining quiet moves, best history score first
+ * 6. captures which lose material by static exchange evaluation
+ * Only legal moves are returned.
+ */
+
+#ifndef MOVE_PICKER_HPP // GUARD
+#define MOVE_PICKER_HPP // GUARD
+
+#include "Board.hpp"
+#include "Move.hpp"
+#include "MoveGenerator.hpp"
+#include "MoveList.hpp"
+
+class MovePicker {
+public:
+  // Constructor:
+  /*
+   * history is the side to move's butterfly table, indexed by origin and
+   * destination square index. Quiets are left in generation order without it.
+   */
+  MovePicker(Board &board, MoveGenerator &move_gen, Move tt_move,
+             Move killer_one, Move killer_two, Move counter_move = Move(),
+             const int (*history)[64] = nullptr);
+
+  /*
+   * Returns the next legal move, or a null move once every move has been
+   * returned.
+   */
+  Move next_move();
+
+  /*
+   * Returns the MVV-LVA score of a capture, en passant or queen promotion:
+   * most valuable victim first, least valuable attacker second.
+   */
+  static int score_capture(Board &board, Move &move);
+
+private:
+  static const uint8_t victim_aggressor_values[6][6]; // [victim][attacker]
+
+  enum Stage {
+    TT_MOVE,
+    GENERATE_CAPTURES,
+    CAPTURES,
+    KILLERS,
+    COUNTER_MOVE,
+    GENERATE_QUIETS,
+    QUIETS,
+    BAD_CAPTURES,
+    DONE
+  };
+
+  Board &board;
+  MoveGenerator &move_gen;
+  Color color;
+  bitboard checkers;
+  bitboard pinned;
+
+  Stage stage;
+  Move tt_move;
+  Move killers[2];
+  size_t killer_index;
+  Move counter_move;
+  const int (*history)[64];
+
+  ScoredMoveList moves;
+  size_t move_index;
+  MoveList bad_captures;
+  size_t bad_capture_index;
+
+  // Helpers:
+  void score_captures();
+  void score_quiets();
+  bool is_valid_quiet(Move &move);
+  bool is_already_tried(Move &move);
+  bool is_legal(Move &move);
+};
+
+#endif // GUARD
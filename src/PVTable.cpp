@@ -7,18 +7,32 @@
 
 #include "PVTable.hpp"
 
+#include <assert.h>
+#include <cstring>
+
+void PVTable::clear() {
+  for (unsigned ply = 0; ply < MAX_DEPTH; ++ply) {
+    pv_lengths[ply] = 0;
+  }
+}
+
 void PVTable::add_move(unsigned ply, Move& move) {
-  pv_length = std::max(pv_length, ply + 1);
+  assert(ply < MAX_DEPTH);
   unsigned pv_index = (ply * (2 * MAX_DEPTH + 1 - ply)) / 2;
   unsigned pv_next_index = pv_index + MAX_DEPTH - ply;
   pv_table[pv_index] = move;
-  memcpy(pv_table + pv_index + 1, pv_table + pv_next_index, sizeof(Move) * pv_length);
+  // the move is followed by the line of the ply below, which fits in this
+  // row as the row of a ply has room for MAX_DEPTH - ply moves
+  unsigned copy_length = ply + 1 < MAX_DEPTH ? pv_lengths[ply + 1] : 0;
+  memmove(pv_table + pv_index + 1, pv_table + pv_next_index,
+          sizeof(Move) * copy_length);
+  pv_lengths[ply] = copy_length + 1;
 }
 
+// Prints the line of the root ply.
 void PVTable::print_pv() {
-  for (int i = 0; i < pv_length; ++i) {
-    pv_table[i].print();
-    std::cout << " ";
+  for (unsigned i = 0; i < pv_lengths[0] && !pv_table[i].is_null(); ++i) {
+    std::cout << pv_table[i].to_uci_notation() << " ";
   }
 }
 
@@ -9,13 +9,21 @@
 
 class PVTable {
 public:
+  /*
+   * Forgets every line, at the start of a search.
+   */
+  void clear();
+  /*
+   * Forgets the line of a ply, on entering a node at that ply.
+   */
+  inline void clear_ply(unsigned ply) { pv_lengths[ply] = 0; }
   void add_move(unsigned ply, Move &move);
   void print_pv();
   
 private:
   static const unsigned MAX_DEPTH = 64; // TODO: perhaps this should be a global option
   Move pv_table[(MAX_DEPTH * MAX_DEPTH + MAX_DEPTH) / 2];
-  unsigned pv_length = 0;
+  unsigned pv_lengths[MAX_DEPTH] = {}; // moves in the row of each ply
 };
 
 #endif // GUARD
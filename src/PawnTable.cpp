@@ -0,0 +1,42 @@
+/*
+ * Pawn hash table implementation.
+ */
+
+#ifndef PAWN_TABLE_CPP // GUARD
+#define PAWN_TABLE_CPP // GUARD
+
+#include "PawnTable.hpp"
+
+#include <assert.h>
+#include <cstdlib>
+
+PawnTable::PawnTable(size_t size_kb) {
+  static_assert(sizeof(PawnEntry) == ENTRY_SIZE,
+                "PawnEntry should fill half a cache line");
+  uint64_t max_entries = ((uint64_t)size_kb << 10) / ENTRY_SIZE;
+  assert(max_entries > 0);
+  size = 1;
+  while (size * 2 <= max_entries) {
+    size *= 2;
+  }
+  index_mask = size - 1;
+
+  memory = malloc(size * ENTRY_SIZE + ENTRY_SIZE - 1);
+  assert(memory != nullptr);
+  uintptr_t aligned = ((uintptr_t)memory + ENTRY_SIZE - 1) & ~(ENTRY_SIZE - 1);
+  p_table = (PawnEntry *)aligned;
+  clear();
+}
+
+PawnTable::~PawnTable() { free(memory); }
+
+void PawnTable::clear() {
+  for (uint64_t i = 0; i < size; i++) {
+    p_table[i].pawn_zkey = 0;
+    p_table[i].passed_pawns[WHITE] = 0;
+    p_table[i].passed_pawns[BLACK] = 0;
+    p_table[i].score = 0;
+  }
+}
+
+#endif // GUARD
@@ -0,0 +1,62 @@
+/*
+ * Pawn hash table class.
+ * Caches the evaluation of pawn structures by their pawn zobrist key. The
+ * pawns move on few of the moves searched, so almost every lookup hits.
+ */
+
+#ifndef PAWN_TABLE_HPP // GUARD
+#define PAWN_TABLE_HPP // GUARD
+
+#include "globals.hpp"
+
+#include <cstddef>
+
+/*
+ * An entry fills half a cache line, and entries are aligned to their size,
+ * so a lookup reads a single cache line.
+ */
+struct alignas(32) PawnEntry {
+  uint64_t pawn_zkey;
+  bitboard passed_pawns[2]; // by color
+  int score; // packed midgame and endgame score from white's point of view
+};
+
+/*
+ * Each search thread evaluates with its own table, so there is no locking.
+ * A table starts out as entries for the position without pawns, whose key is
+ * zero and whose score is zero.
+ */
+class PawnTable {
+public:
+  static const size_t DEFAULT_SIZE_KB = 256;
+
+  PawnTable(size_t size_kb = DEFAULT_SIZE_KB);
+  ~PawnTable();
+  PawnTable(const PawnTable &) = delete;
+  PawnTable &operator=(const PawnTable &) = delete;
+
+  /*
+   * Returns the slot for pawn_zkey. It holds another pawn structure unless
+   * its key matches, in which case the caller evaluates and overwrites it.
+   */
+  inline PawnEntry &get_entry(uint64_t pawn_zkey) {
+    return p_table[pawn_zkey & index_mask];
+  }
+
+  /*
+   * Empties every entry.
+   */
+  void clear();
+
+  inline uint64_t get_size() { return size; }
+
+private:
+  static const size_t ENTRY_SIZE = 32;
+
+  void *memory; // allocation holding the aligned p_table
+  PawnEntry *p_table;
+  uint64_t size; // number of entries
+  uint64_t index_mask;
+};
+
+#endif // GUARD
@@ -2,11 +2,29 @@
 #define SEARCH_CPP // GUARD
 
 #include "Search.hpp"
+#include "ThreadPool.hpp"
 #include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
 #include <random>
 
+PruningParameters Search::pruning;
+
 // Constructor:
-Search::Search() : best_move(0, 0, -1) {}
+Search::Search(TTable &t_table, std::atomic<bool> &stop_flag,
+               unsigned thread_id, ThreadPool *thread_pool)
+    : thread_id(thread_id), thread_pool(thread_pool), stop_flag(stop_flag),
+      best_move(0, 0, -1), t_table(t_table) {
+  static const bool reductions_initialized = initialize_reductions();
+  (void)reductions_initialized;
+  null_move_min_ply = 0;
+  nodes_evaluated = 0;
+  pondering = false;
+  clock_started = false;
+  clear_heuristics();
+}
 
 // Getters:
 Move Search::get_best_move() { return best_move; }
@@ -173,242 +191,772 @@ int Search::negamax_root(int depth, Board &board, MoveGenerator &move_gen,
 // Iterative Deepening:
 int Search::negamax_id(int depth, int alpha, int beta, Board &board,
                        MoveGenerator &move_gen, Evaluation &eval) {
-  if (depth == 0) {
-    if (board.get_last_move(negate_color(board.get_turn_color()))
-            .is_capture()) {
-      return quiescence_search(alpha, beta, board, move_gen, eval);
-    } else {
-      return eval.evaluate(board) * (board.get_turn_color() == WHITE ? 1 : -1);
+  // set while testing whether the hash move is singular, see below; that
+  // test searches this ply again and must leave its pv alone
+  Move excluded_move = excluded_moves[current_ply];
+  bool is_excluding = !excluded_move.is_null();
+  if (!is_excluding) {
+    pv_table.clear_ply(current_ply);
+  }
+  if (should_stop()) {
+    return 0;
+  }
+
+  if (board.is_draw()) {
+    return 0;
+  }
+  // the side to move can go back to an earlier position, so it can at least
+  // draw by repetition
+  if (alpha < 0 && board.has_upcoming_repetition(current_ply)) {
+    alpha = 0;
+    if (alpha >= beta) {
+      return alpha;
     }
   }
 
+  if (depth == 0) {
+    return quiescence_search(alpha, beta, board, move_gen, eval);
+  }
+
+  Color color = board.get_turn_color();
+  if (current_ply >= MAX_PLY - 1) {
+    return eval.evaluate(board) * (color == WHITE ? 1 : -1);
+  }
+
   int previous_alpha = alpha;
 
   uint64_t position_zkey = board.get_zkey();
-  // use tt if possible
-  TTEntry tt_entry = t_table.probe_entry(position_zkey, depth);
-  if (tt_entry.get_type() == TTEntryType::Value::EXACT) {
-    return tt_entry.get_score();
-  } else if (tt_entry.get_type() == TTEntryType::Value::UPPER &&
-             tt_entry.get_score() <= alpha) {
-    return alpha;
-  } else if (tt_entry.get_type() == TTEntryType::Value::LOWER &&
-             tt_entry.get_score() >= beta) {
+  // use tt if possible; the hash move is used for ordering at any depth
+  TTEntry tt_entry = t_table.probe_entry(position_zkey, 0);
+  Move tt_move = tt_entry.get_best_move();
+  int tt_score = score_from_tt(tt_entry.get_score(), current_ply);
+  if (!is_excluding && tt_entry.get_depth() >= depth) {
+    if (tt_entry.get_type() == TTEntryType::Value::EXACT) {
+      return tt_score;
+    } else if (tt_entry.get_type() == TTEntryType::Value::UPPER &&
+               tt_score <= alpha) {
+      return alpha;
+    } else if (tt_entry.get_type() == TTEntryType::Value::LOWER &&
+               tt_score >= beta) {
+      return beta;
+    }
+  }
+
+  bool in_check = board.is_checked(color);
+  bool is_pv_node = beta - alpha > 1;
+  bool can_prune_node = !is_pv_node && !in_check && !is_excluding;
+  int static_eval =
+      in_check ? -INFINITE_SCORE
+               : eval.evaluate(board) * (color == WHITE ? 1 : -1);
+
+  // razoring: far below alpha near the horizon, only captures can save us,
+  // so let quiescence search decide
+  if (can_prune_node && depth <= pruning.razoring_max_depth &&
+      static_eval + pruning.razoring_margin * depth < alpha) {
+    int score = quiescence_search(alpha, alpha + 1, board, move_gen, eval);
+    if (score <= alpha) {
+      return alpha;
+    }
+  }
+
+  // reverse futility pruning: far enough above beta that no opponent move
+  // is expected to bring us back down
+  if (can_prune_node && depth <= pruning.reverse_futility_max_depth &&
+      beta < MATE_BOUND &&
+      static_eval - pruning.reverse_futility_margin * depth >= beta) {
     return beta;
   }
 
-  int best_score = -999999;
-  MoveList moves = move_gen.generate_legal_moves(board, board.get_turn_color());
+  if (!is_excluding && is_null_move_allowed(depth, alpha, beta, in_check,
+                                            static_eval, board)) {
+    // adaptive: deeper nodes are reduced more
+    int reduction = NULL_MOVE_REDUCTION + depth / 6;
+    int null_depth = std::max(depth - 1 - reduction, 0);
+    board.make_null_move();
+    ++current_ply;
+    int score = -negamax_id(null_depth, -beta, -beta + 1, board, move_gen, eval);
+    board.undo_null_move();
+    --current_ply;
+    if (stop_flag.load(std::memory_order_relaxed)) {
+      return 0;
+    }
+
+    if (score >= beta) {
+      if (depth < NULL_MOVE_VERIFICATION_DEPTH) {
+        return beta;
+      }
+      // at high depth, confirm with a reduced search of our own moves in
+      // which null moves are not tried near the root, so that zugzwang
+      // positions are not pruned on the null move's word alone
+      unsigned previous_min_ply = null_move_min_ply;
+      null_move_min_ply = current_ply + 3 * null_depth / 4;
+      score = negamax_id(null_depth, beta - 1, beta, board, move_gen, eval);
+      null_move_min_ply = previous_min_ply;
+      if (score >= beta) {
+        return beta;
+      }
+    }
+  }
+
+  int best_score = -INFINITE_SCORE;
+  int legal_moves = 0;
+  Move counter_move;
+  if (!board.is_moves_empty(negate_color(color))) {
+    Move previous_move = board.get_last_move(negate_color(color));
+    counter_move = counter_moves[previous_move.get_origin_index()]
+                                [previous_move.get_destination_index()];
+  }
+  MovePicker move_picker(board, move_gen, tt_move,
+                         killer_moves[current_ply][0],
+                         killer_moves[current_ply][1], counter_move,
+                         history[color]);
+  Move quiets_tried[256];
+  int quiets_tried_count = 0;
+
+  // futility pruning and late move pruning skip quiets that are unlikely to
+  // raise alpha, once one move has been searched
+  bool can_prune_quiets = can_prune_node && alpha > -MATE_BOUND;
+  bool futile = can_prune_quiets && depth <= pruning.futility_max_depth &&
+                static_eval + pruning.futility_margin * depth <= alpha;
+  int late_move_count =
+      can_prune_quiets && depth <= pruning.late_move_pruning_max_depth
+          ? pruning.late_move_pruning_base + depth * depth
+          : 256;
+
+  // the hash move is singular if every other move fails low against a bound
+  // a little below its score, in which case it alone is searched deeper
+  bool is_singular_candidate =
+      depth >= SINGULAR_MIN_DEPTH && !is_excluding &&
+      (tt_entry.get_type() == TTEntryType::Value::LOWER ||
+       tt_entry.get_type() == TTEntryType::Value::EXACT) &&
+      tt_entry.get_depth() >= depth - 3 &&
+      std::abs(tt_score) < MATE_BOUND;
 
-  Move null_move = Move();
-  sort_moves(moves, null_move, null_move, board); // pv move and tt move disabled for now
-  
   Move local_best_move;
-  for (int i = 0; i < moves.size(); i++) {
-    board.execute_move(moves[i]);
-    ++nodes_evaluated;
+  for (Move move = move_picker.next_move(); !move.is_null();
+       move = move_picker.next_move()) {
+    if (move.move_equals(excluded_move)) {
+      continue;
+    }
+    ++legal_moves;
+    if (legal_moves > 1 && move.is_quiet() &&
+        (futile || quiets_tried_count >= late_move_count)) {
+      continue;
+    }
+    // near the horizon, captures losing more than a pawn per ply of depth
+    // left are not worth searching
+    if (can_prune_quiets && legal_moves > 1 && !move.is_quiet() &&
+        depth <= SEE_PRUNING_MAX_DEPTH &&
+        !board.see_ge(move, -SEE_PRUNING_MARGIN * depth)) {
+      continue;
+    }
+
+    // extensions, at most one ply per move and root depth plies per line
+    int extension = 0;
+    bool can_extend = line_extensions < root_depth;
+    if (can_extend && is_singular_candidate && move.move_equals(tt_move)) {
+      int singular_beta = tt_score - 2 * depth;
+      excluded_moves[current_ply] = move;
+      int score = negamax_id((depth - 1) / 2, singular_beta - 1, singular_beta,
+                             board, move_gen, eval);
+      excluded_moves[current_ply] = Move();
+      if (stop_flag.load(std::memory_order_relaxed)) {
+        return 0;
+      }
+      if (score < singular_beta) {
+        extension = 1;
+      } else if (singular_beta >= beta) {
+        // multi-cut: another move also beats beta without the hash move
+        return beta;
+      }
+    }
+
+    board.execute_move(move);
+    count_node();
     ++current_ply;
-    int score = -negamax_id(depth - 1, -beta, -alpha, board, move_gen, eval);
-    board.undo_move(moves[i]);
+    bool gives_check = board.is_checked(negate_color(color));
+    if (can_extend && gives_check) {
+      extension = 1;
+    }
+    line_extensions += extension;
+    int new_depth = depth - 1 + extension;
+
+    // principal variation search: only the first move is expected to be
+    // inside the window, the rest are proven worse with a zero window and
+    // searched again only if that fails
+    int score;
+    if (legal_moves == 1) {
+      score = -negamax_id(new_depth, -beta, -alpha, board, move_gen, eval);
+    } else {
+      int reduction = 0;
+      if (depth >= LMR_MIN_DEPTH && legal_moves > LMR_MIN_MOVES &&
+          move.is_quiet() && !in_check) {
+        reduction = get_reduction(depth, legal_moves, is_pv_node, gives_check,
+                                  history[color][move.get_origin_index()]
+                                         [move.get_destination_index()]);
+      }
+      score = -negamax_id(new_depth - reduction, -alpha - 1, -alpha, board,
+                          move_gen, eval);
+      if (reduction > 0 && score > alpha) {
+        score =
+            -negamax_id(new_depth, -alpha - 1, -alpha, board, move_gen, eval);
+      }
+      if (score > alpha && score < beta) {
+        score = -negamax_id(new_depth, -beta, -alpha, board, move_gen, eval);
+      }
+    }
+    line_extensions -= extension;
+    board.undo_move(move);
     --current_ply;
 
+    if (stop_flag.load(std::memory_order_relaxed)) {
+      return 0; // the subtree was not searched, keep it out of the tt
+    }
+
     if (score >= beta) {
-      t_table.set_entry(position_zkey, depth, TTEntryType::Value::LOWER,
-                        moves[i], score);
+      ++beta_cutoffs;
+      if (legal_moves == 1) {
+        ++first_move_cutoffs;
+      }
+      if (move.is_quiet()) {
+        update_quiet_heuristics(board, move, quiets_tried, quiets_tried_count,
+                                depth);
+      }
+      if (!is_excluding) {
+        t_table.set_entry(position_zkey, depth, TTEntryType::Value::LOWER,
+                          move, score_to_tt(score, current_ply));
+      }
       return beta;
     }
+    if (move.is_quiet()) {
+      quiets_tried[quiets_tried_count++] = move;
+    }
     if (score > best_score) {
       best_score = score;
-      local_best_move = moves[i];
+      local_best_move = move;
 
       if (score > alpha) {
         alpha = score;
-        pv_table.add_move(current_ply, local_best_move);
+        if (!is_excluding) {
+          pv_table.add_move(current_ply, local_best_move);
+        }
       }
     }
   }
 
+  if (legal_moves == 0) {
+    if (is_excluding) { // the excluded move is the only move
+      return alpha;
+    }
+    // checkmate or stalemate
+    return in_check ? -MATE_SCORE + (int)current_ply : 0;
+  }
+
+  if (is_excluding) {
+    return alpha;
+  }
   if (alpha > previous_alpha) {
     t_table.set_entry(position_zkey, depth, TTEntryType::Value::EXACT,
-                      local_best_move, best_score);
+                      local_best_move, score_to_tt(best_score, current_ply));
   } else {
     t_table.set_entry(position_zkey, depth, TTEntryType::Value::UPPER,
-                      local_best_move, alpha);
+                      local_best_move, score_to_tt(alpha, current_ply));
   }
 
   return alpha;
 }
 
-int Search::negamax_root_iterative_deepening(unsigned time_limit, Board &board,
-                                             MoveGenerator &move_gen,
-                                             Evaluation &eval) {
-  unsigned search_depth = 1;
+int Search::negamax_root_iterative_deepening(
+    const SearchLimits &search_limits, Board &board, MoveGenerator &move_gen,
+    Evaluation &eval) {
+  // helper threads start every other depth one ply deeper, so that threads
+  // sharing the tt do not all search the same iteration at the same time
+  unsigned search_depth = 1 + thread_id % 2;
   current_ply = 0;
 
-  // start the clock
-  std::chrono::high_resolution_clock::time_point start_time =
-      std::chrono::high_resolution_clock::now();
-  std::chrono::high_resolution_clock::time_point current_time;
-  unsigned time_passed;
+  limits = search_limits;
+  clock_started = false;
+  get_time_passed(); // starts the clock unless pondering
 
   nodes_evaluated = 0;
+  pv_table.clear();
+  beta_cutoffs = 0;
+  first_move_cutoffs = 0;
+  for (unsigned ply = 0; ply < MAX_PLY; ply++) {
+    killer_moves[ply][0] = Move();
+    killer_moves[ply][1] = Move();
+  }
+
+  // a move to play even if the first iteration is aborted
+  MoveList legal_moves =
+      limits.search_moves.size() > 0
+          ? limits.search_moves
+          : move_gen.generate_legal_moves(board, board.get_turn_color());
+  Move completed_best_move = legal_moves.size() > 0 ? legal_moves[0] : Move();
+  best_move = completed_best_move;
 
+  int score = 0;
   while (true) {
-    int alpha = -999999;
-    int beta = -alpha;
-    int score = 0;
+    age_heuristics();
 
     uint64_t position_zkey = board.get_zkey();
     TTEntry tt_entry = t_table.probe_entry(position_zkey, search_depth);
 
-    if (tt_entry.get_type() == TTEntryType::Value::EXACT) { // TT hit
+    // the hash move may not be among the moves we were asked to search
+    if (tt_entry.get_type() == TTEntryType::Value::EXACT &&
+        limits.search_moves.size() == 0) { // TT hit
       best_move = tt_entry.get_best_move();
-      alpha = tt_entry.get_score();
+      score = score_from_tt(tt_entry.get_score(), current_ply);
+      // nothing was searched, so the hash move is the whole line
+      pv_table.clear();
+      pv_table.add_move(0, best_move);
     } else { // TT miss
-      MoveList moves = move_gen.generate_legal_moves(board, board.get_turn_color());
-
-      Move null_move = Move();
-      sort_moves(moves, null_move, null_move, board); // pv move and tt move disabled for now
-      
-      for (int i = 0; i < moves.size(); i++) {
-        board.execute_move(moves[i]);
-        ++nodes_evaluated;
-        ++current_ply;
-        int score =
-            -negamax_id(search_depth - 1, -beta, -alpha, board, move_gen, eval);
-        board.undo_move(moves[i]);
-        --current_ply;
-        if (score > alpha) {
-          alpha = score;
-          best_move = moves[i];
-          pv_table.add_move(current_ply, best_move);
-        }
+      int previous_score = score;
+      score = aspiration_search(search_depth, previous_score, board, move_gen,
+                                eval);
+      if (stop_flag.load(std::memory_order_relaxed)) {
+        // the interrupted iteration is not trusted
+        best_move = completed_best_move;
+        return previous_score;
+      }
+      if (limits.search_moves.size() == 0) {
+        t_table.set_entry(position_zkey, search_depth,
+                          TTEntryType::Value::EXACT, best_move,
+                          score_to_tt(score, current_ply));
       }
+    }
+    completed_best_move = best_move;
+
+    unsigned time_passed = get_time_passed();
+    if (thread_id == 0) {
+      print_info(search_depth, score, time_passed);
+    }
+
+    ++search_depth;
 
-      t_table.set_entry(position_zkey, search_depth, TTEntryType::Value::EXACT,
-                        best_move, alpha);
-
-      // check the clock
-      current_time = std::chrono::high_resolution_clock::now();
-      time_passed = std::chrono::duration_cast<std::chrono::milliseconds>(
-                        current_time - start_time)
-                        .count();
-      if (time_passed > 0.25 * time_limit) {
-        std::cout << "info";
-        std::cout << " depth " << search_depth;
-        std::cout << " score cp " << alpha;
-        std::cout << " nodes " << nodes_evaluated;
-        std::cout << " nps " << (float)nodes_evaluated / time_passed * 1000;
-        std::cout << " time " << time_passed;
-        std::cout << " pv ";
-        pv_table.print_pv();
-        std::cout << std::endl;
-
-        return alpha;
+    // helpers keep searching until the main thread stops them; killers and
+    // the pv table only have room for MAX_PLY plies
+    if (search_depth >= MAX_PLY) {
+      return score;
+    }
+    if (thread_id == 0) {
+      bool mate_found =
+          limits.mate && score >= MATE_SCORE - (int)(2 * limits.mate - 1);
+      bool out_of_time =
+          limits.soft_time && clock_started && time_passed > limits.soft_time;
+      if ((limits.depth && search_depth > limits.depth) || mate_found ||
+          out_of_time) {
+        return score;
       }
     }
+  }
+}
 
-    // check the clock
-    current_time = std::chrono::high_resolution_clock::now();
-    time_passed = std::chrono::duration_cast<std::chrono::milliseconds>(
-                      current_time - start_time)
-                      .count();
+/*
+ * Searches the root in a window around the previous iteration's score,
+ * widening the side that fails until the score falls inside the window.
+ * Shallow iterations, whose scores swing the most, use a full window.
+ */
+int Search::aspiration_search(unsigned depth, int previous_score, Board &board,
+                              MoveGenerator &move_gen, Evaluation &eval) {
+  int delta = ASPIRATION_WINDOW;
+  int alpha = -INFINITE_SCORE;
+  int beta = INFINITE_SCORE;
+  if (depth >= ASPIRATION_MIN_DEPTH) {
+    alpha = previous_score - delta;
+    beta = previous_score + delta;
+  }
 
-    // send info
-    std::cout << "info";
-    std::cout << " depth " << search_depth;
-    std::cout << " score cp " << alpha;
-    std::cout << " nodes " << nodes_evaluated;
-    std::cout << " nps " << (float)nodes_evaluated / time_passed * 1000;
-    std::cout << " time " << time_passed;
-    std::cout << " pv ";
-    pv_table.print_pv();
-    std::cout << std::endl;
+  while (true) {
+    int score = search_root(depth, alpha, beta, board, move_gen, eval);
+    if (stop_flag.load(std::memory_order_relaxed)) {
+      return score;
+    }
 
-    ++search_depth;
+    // scores never reach +-INFINITE_SCORE, so widening always terminates
+    if (score <= alpha && alpha > -INFINITE_SCORE) { // fail low
+      alpha -= delta;
+    } else if (score >= beta && beta < INFINITE_SCORE) { // fail high
+      beta += delta;
+    } else {
+      return score;
+    }
+    delta *= 2;
+  }
+}
 
-    if (time_passed > 0.5 * time_limit) {
+/*
+ * One root iteration. The previous best move is searched first with the full
+ * window and the rest with a zero window, as in negamax_id.
+ */
+int Search::search_root(unsigned depth, int alpha, int beta, Board &board,
+                        MoveGenerator &move_gen, Evaluation &eval) {
+  root_depth = depth;
+  line_extensions = 0;
+  pv_table.clear_ply(current_ply);
+
+  MoveList legal_moves =
+      limits.search_moves.size() > 0
+          ? limits.search_moves
+          : move_gen.generate_legal_moves(board, board.get_turn_color());
+
+  // the previous iteration's best move is searched first
+  Move pv_move = best_move;
+  Move tt_move = t_table.probe_entry(board.get_zkey(), 0).get_best_move();
+  ScoredMoveList moves;
+  score_moves(legal_moves, moves, pv_move, tt_move, board);
+
+  for (size_t i = 0; i < moves.size(); i++) {
+    Move &move = moves.pick_best(i);
+    board.execute_move(move);
+    count_node();
+    ++current_ply;
+    int score;
+    if (i == 0) {
+      score = -negamax_id(depth - 1, -beta, -alpha, board, move_gen, eval);
+    } else {
+      score = -negamax_id(depth - 1, -alpha - 1, -alpha, board, move_gen, eval);
+      if (score > alpha && score < beta) {
+        score = -negamax_id(depth - 1, -beta, -alpha, board, move_gen, eval);
+      }
+    }
+    board.undo_move(move);
+    --current_ply;
+    if (stop_flag.load(std::memory_order_relaxed)) {
       return alpha;
     }
+    if (score > alpha) {
+      best_move = move;
+      pv_table.add_move(current_ply, best_move);
+      if (score >= beta) {
+        return beta;
+      }
+      alpha = score;
+    }
   }
+
+  return alpha;
 }
 
 // https://www.chessprogramming.org/Quiescence_Search
 int Search::quiescence_search(int alpha, int beta, Board &board,
                               MoveGenerator &move_gen, Evaluation &eval) {
-  int stand_pat =
-      eval.evaluate(board) * (board.get_turn_color() == WHITE ? 1 : -1);
-  int best_value = stand_pat;
+  pv_table.clear_ply(current_ply);
+  if (should_stop()) {
+    return 0;
+  }
 
-  if (stand_pat >= beta) {
-    return stand_pat;
+  Color color = board.get_turn_color();
+  bool in_check = board.is_checked(color);
+  if (current_ply >= MAX_PLY - 1) {
+    return in_check ? 0 : eval.evaluate(board) * (color == WHITE ? 1 : -1);
   }
-  if (alpha < stand_pat) {
-    alpha = stand_pat;
+
+  // quiescence entries are stored at depth 0, so any entry is deep enough
+  uint64_t position_zkey = board.get_zkey();
+  TTEntry tt_entry = t_table.probe_entry(position_zkey, 0);
+  int tt_score = score_from_tt(tt_entry.get_score(), current_ply);
+  if (tt_entry.get_type() == TTEntryType::Value::EXACT) {
+    return tt_score;
+  } else if (tt_entry.get_type() == TTEntryType::Value::UPPER &&
+             tt_score <= alpha) {
+    return alpha;
+  } else if (tt_entry.get_type() == TTEntryType::Value::LOWER &&
+             tt_score >= beta) {
+    return beta;
   }
 
-  MoveList moves = move_gen.generate_legal_moves(board, board.get_turn_color());
-  for (int i = 0; i < moves.size(); ++i) {
-    if (moves[i].is_capture()) {
-      board.execute_move(moves[i]);
-      ++current_ply;
-      int score = -quiescence_search(-beta, -alpha, board, move_gen, eval);
-      board.undo_move(moves[i]);
-      --current_ply;
+  // in check there is no standing pat: every evasion is searched, and if
+  // there is none the side to move is mated
+  int previous_alpha = alpha;
+  int stand_pat = -INFINITE_SCORE;
+  int best_value = -MATE_SCORE + (int)current_ply;
+  if (!in_check) {
+    stand_pat = eval.evaluate(board) * (color == WHITE ? 1 : -1);
+    best_value = stand_pat;
+    if (stand_pat >= beta) {
+      return stand_pat;
+    }
+    if (alpha < stand_pat) {
+      alpha = stand_pat;
+    }
+  }
 
-      if (score >= beta) {
-        return score;
-      }
-      if (score > best_value) {
-        best_value = score;
+  MoveList moves = move_gen.generate_legal_moves(
+      board, color,
+      in_check ? GenerationMode::Value::EVASIONS
+               : GenerationMode::Value::CAPTURES);
+  ScoredMoveList scored_moves;
+  for (size_t i = 0; i < moves.size(); i++) {
+    scored_moves.add_move(moves[i], moves[i].is_quiet()
+                                        ? 0
+                                        : MovePicker::score_capture(board,
+                                                                    moves[i]));
+  }
+
+  Move local_best_move;
+  for (size_t i = 0; i < scored_moves.size(); ++i) {
+    Move &move = scored_moves.pick_best(i);
+    if (!in_check) {
+      // delta pruning: even winning the captured piece for free cannot
+      // bring the score back up to alpha
+      if (stand_pat + get_capture_gain(move, board) + DELTA_MARGIN <= alpha) {
+        continue;
       }
-      if (score > alpha) {
-        alpha = score;
+      if (!board.see_ge(move, 0)) {
+        continue; // loses material
       }
     }
+
+    board.execute_move(move);
+    count_node();
+    ++current_ply;
+    int score = -quiescence_search(-beta, -alpha, board, move_gen, eval);
+    board.undo_move(move);
+    --current_ply;
+    if (stop_flag.load(std::memory_order_relaxed)) {
+      return 0;
+    }
+
+    if (score >= beta) {
+      t_table.set_entry(position_zkey, 0, TTEntryType::Value::LOWER, move,
+                        score_to_tt(score, current_ply));
+      return score;
+    }
+    if (score > best_value) {
+      best_value = score;
+      local_best_move = move;
+    }
+    if (score > alpha) {
+      alpha = score;
+    }
   }
 
+  t_table.set_entry(position_zkey, 0,
+                    alpha > previous_alpha ? TTEntryType::Value::EXACT
+                                           : TTEntryType::Value::UPPER,
+                    local_best_move, score_to_tt(best_value, current_ply));
   return best_value;
 }
 
-struct move_exp{
-  Move move16;
-  unsigned score;
-};
-
-// TODO: move this to a dedicated move ordering class
-// TODO: optimize
-void Search::sort_moves(MoveList& moves, Move& pv_move, Move& tt_move, Board& board) {
-  unsigned PV_BASE = 300;
-  unsigned TT_BASE = 200;
-  unsigned MMV_LVA_BASE = 100;
-
-  move_exp sorted_moves[256];
-  int num_moves = moves.size();
-  for (int i = 0; i < num_moves; i++) {
+// PV move first, then the hash move, then captures by MVV-LVA, then quiets.
+void Search::score_moves(MoveList &moves, ScoredMoveList &scored_moves,
+                         Move &pv_move, Move &tt_move, Board &board) {
+  const int PV_BASE = 300;
+  const int TT_BASE = 200;
+  const int MVV_LVA_BASE = 100;
+
+  for (size_t i = 0; i < moves.size(); i++) {
     Move &move = moves[i];
-    
-    if (move.is_capture()) {
-      Piece moved_piece = board.get_piece_at_position(move.get_origin(), board.get_turn_color());
-      Piece captured_piece = board.get_piece_at_position(move.get_destination(), board.get_turn_color());
-      sorted_moves[i] = {move, MMV_LVA_BASE + victim_aggressor_values[moved_piece][captured_piece]};
+    if (move.move_equals(pv_move)) {
+      scored_moves.add_move(move, PV_BASE);
+    } else if (move.move_equals(tt_move)) {
+      scored_moves.add_move(move, TT_BASE);
+    } else if (move.is_capture() || move.get_flags() == 11) {
+      scored_moves.add_move(
+          move, MVV_LVA_BASE + MovePicker::score_capture(board, move));
     } else {
-      sorted_moves[i] = {move, 0};
+      scored_moves.add_move(move, 0);
     }
   }
+}
 
-  std::sort(sorted_moves, sorted_moves + num_moves, [](move_exp m1, move_exp m2) {
-    return m1.score > m2.score;
-  });
+/*
+ * Null move pruning: if passing the turn still fails high, a real move would
+ * too. Not tried in pv nodes, in check, below beta, twice in a row, or when
+ * the side to move only has pawns left, where passing may be better than any
+ * move.
+ */
+bool Search::is_null_move_allowed(int depth, int alpha, int beta,
+                                  bool in_check, int static_eval,
+                                  Board &board) {
+  Color color = board.get_turn_color();
+  if (depth < NULL_MOVE_MIN_DEPTH || beta - alpha > 1 ||
+      current_ply < null_move_min_ply || in_check || static_eval < beta) {
+    return false;
+  }
+  if (!board.is_moves_empty(negate_color(color)) &&
+      board.get_last_move(negate_color(color)).is_null()) {
+    return false;
+  }
+  bitboard pieces = board.get_all_piece_positions(color) &
+                    ~board.get_piece_positions(PAWN, color) &
+                    ~board.get_piece_positions(KING, color);
+  return pieces != 0;
+}
+
+/*
+ * Late move reductions: quiet moves late in the ordered list rarely beat
+ * alpha, so they are searched shallower first, by log(depth) * log(move
+ * number) plies. Reduced less in pv nodes, for checking moves and for moves
+ * with a good history, and never below depth 1.
+ */
+int Search::get_reduction(int depth, int move_number, bool is_pv_node,
+                          bool gives_check, int history_score) {
+  int reduction =
+      lmr_reductions[std::min(depth, 63)][std::min(move_number, 63)];
+  if (is_pv_node) {
+    --reduction;
+  }
+  if (gives_check) {
+    --reduction;
+  }
+  reduction -= history_score / (MAX_HISTORY / 2);
+  return std::max(0, std::min(reduction, depth - 2));
+}
+
+uint8_t Search::lmr_reductions[64][64];
+
+bool Search::initialize_reductions() {
+  for (int depth = 1; depth < 64; depth++) {
+    for (int move_number = 1; move_number < 64; move_number++) {
+      lmr_reductions[depth][move_number] =
+          0.75 + std::log(depth) * std::log(move_number) / 2.25;
+    }
+  }
+  return true;
+}
+
+/*
+ * Called on a beta cutoff by a quiet move. The move becomes a killer at this
+ * ply and the counter move to the opponent's last move. Its history score
+ * rises and the quiets tried before it fall.
+ */
+void Search::update_quiet_heuristics(Board &board, Move &move,
+                                     Move *quiets_tried,
+                                     int quiets_tried_count, int depth) {
+  if (!move.move_equals(killer_moves[current_ply][0])) {
+    killer_moves[current_ply][1] = killer_moves[current_ply][0];
+    killer_moves[current_ply][0] = move;
+  }
+
+  Color color = board.get_turn_color();
+  if (!board.is_moves_empty(negate_color(color)) &&
+      !board.get_last_move(negate_color(color)).is_null()) {
+    Move previous_move = board.get_last_move(negate_color(color));
+    counter_moves[previous_move.get_origin_index()]
+                 [previous_move.get_destination_index()] = move;
+  }
+
+  int bonus = std::min(depth * depth, 400);
+  update_history(color, move, bonus);
+  for (int i = 0; i < quiets_tried_count; i++) {
+    update_history(color, quiets_tried[i], -bonus);
+  }
+}
+
+// Scores saturate towards +-MAX_HISTORY rather than overflowing.
+void Search::update_history(Color color, Move &move, int bonus) {
+  int &entry =
+      history[color][move.get_origin_index()][move.get_destination_index()];
+  entry += bonus - entry * std::abs(bonus) / MAX_HISTORY;
+}
+
+void Search::clear_heuristics() {
+  for (unsigned ply = 0; ply < MAX_PLY; ply++) {
+    killer_moves[ply][0] = Move();
+    killer_moves[ply][1] = Move();
+    excluded_moves[ply] = Move();
+  }
+  memset(history, 0, sizeof(history));
+  for (int origin = 0; origin < 64; origin++) {
+    for (int destination = 0; destination < 64; destination++) {
+      counter_moves[origin][destination] = Move();
+    }
+  }
+  beta_cutoffs = 0;
+  first_move_cutoffs = 0;
+}
+
+// Halves history scores so that the latest iteration weighs the most.
+void Search::age_heuristics() {
+  for (int color = 0; color < 2; color++) {
+    for (int origin = 0; origin < 64; origin++) {
+      for (int destination = 0; destination < 64; destination++) {
+        history[color][origin][destination] /= 2;
+      }
+    }
+  }
+}
+
+// Printers:
+void Search::print_info(unsigned depth, int score, unsigned time_passed) {
+  uint64_t nodes = thread_pool ? thread_pool->get_nodes_evaluated()
+                               : get_nodes_evaluated();
+  std::cout << "info";
+  std::cout << " depth " << depth;
+  if (score >= MATE_BOUND) {
+    std::cout << " score mate " << (MATE_SCORE - score + 1) / 2;
+  } else if (score <= -MATE_BOUND) {
+    std::cout << " score mate " << -(MATE_SCORE + score) / 2;
+  } else {
+    std::cout << " score cp " << score;
+  }
+  std::cout << " nodes " << nodes;
+  if (time_passed > 0) { // UCI wants a whole number, never inf
+    std::cout << " nps " << nodes * 1000 / time_passed;
+  }
+  std::cout << " time " << time_passed;
+  std::cout << " pv ";
+  pv_table.print_pv();
+  std::cout << std::endl;
+
+  if (beta_cutoffs > 0) {
+    std::cout << "info string first move cutoffs "
+              << 100.0 * first_move_cutoffs / beta_cutoffs << "%" << std::endl;
+  }
 }
 
-const uint8_t Search::victim_aggressor_values[6][6] = {
-  {15, 14, 13, 12, 11, 10}, // victim P, aggressor P, K, B, R, Q, K
-  {25, 24, 23, 22, 21, 20}, // victim K, aggressor P, K, B, R, Q, K
-  {35, 36, 37, 38, 39, 40}, // victim B, aggressor P, K, B, R, Q, K
-  {45, 46, 47, 48, 49, 50}, // victim R, aggressor P, K, B, R, Q, K
-  {55, 56, 57, 58, 59, 60}, // victim Q, aggressor P, K, B, R, Q, K
-  {0, 0, 0, 0, 0, 0} // victim K, aggressor P, K, B, R, Q, K
-};
+// Material won by a capture or promotion, ignoring any recapture.
+int Search::get_capture_gain(Move &move, Board &board) {
+  int gain = 0;
+  if (move.get_flags() == 5) {
+    gain = Evaluation::piece_values[PAWN];
+  } else if (move.is_capture()) {
+    gain = Evaluation::piece_values[board.get_piece_at_position(
+        move.get_destination(), negate_color(board.get_turn_color()))];
+  }
+  if (move.get_flags() == 11 || move.get_flags() == 15) {
+    gain += Evaluation::piece_values[QUEEN] - Evaluation::piece_values[PAWN];
+  }
+  return gain;
+}
+
+/*
+ * Whether the search should unwind. The main thread raises the shared stop
+ * flag once the node limit is reached, and reads the clock every
+ * NODES_PER_TIME_CHECK nodes to do the same past the hard time limit.
+ */
+bool Search::should_stop() {
+  if (thread_id == 0) {
+    uint64_t nodes = get_nodes_evaluated();
+    if (limits.nodes && nodes >= limits.nodes) {
+      stop_flag = true;
+    } else if (limits.hard_time && (nodes & (NODES_PER_TIME_CHECK - 1)) == 0 &&
+               get_time_passed() >= limits.hard_time) {
+      stop_flag = true;
+    }
+  }
+  return stop_flag.load(std::memory_order_relaxed);
+}
+
+/*
+ * Milliseconds since the clock was started, which happens on the first call
+ * that is not pondering.
+ */
+unsigned Search::get_time_passed() {
+  std::chrono::high_resolution_clock::time_point now =
+      std::chrono::high_resolution_clock::now();
+  if (!clock_started) {
+    if (pondering) {
+      return 0;
+    }
+    start_time = now;
+    clock_started = true;
+  }
+  return std::chrono::duration_cast<std::chrono::milliseconds>(now -
+                                                               start_time)
+      .count();
+}
 
 #endif // GUARD
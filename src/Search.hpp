@@ -9,16 +9,71 @@
 #include "Evaluation.hpp"
 #include "MoveGenerator.hpp"
 #include "MoveList.hpp"
+#include "MovePicker.hpp"
 #include "PVTable.hpp"
 #include "TTable.hpp"
 
+#include <atomic>
+#include <chrono>
+
+class ThreadPool;
+
+/*
+ * Forward pruning margins and depth limits. Margins are in centipawns per ply
+ * of remaining depth. They are shared by every search thread and exposed as
+ * UCI options so that they can be tuned without rebuilding.
+ */
+struct PruningParameters {
+  int reverse_futility_margin = 90;
+  int reverse_futility_max_depth = 6;
+  int futility_margin = 120;
+  int futility_max_depth = 5;
+  int razoring_margin = 250;
+  int razoring_max_depth = 2;
+  int late_move_pruning_base = 3; // quiets searched: base + depth * depth
+  int late_move_pruning_max_depth = 5;
+};
+
+/*
+ * Limits of a single search, as given by the UCI go command. A limit of 0 is
+ * no limit. A search with no limit at all, or an infinite one, only ends
+ * when it is stopped.
+ */
+struct SearchLimits {
+  unsigned depth = 0;
+  uint64_t nodes = 0;    // searched by the main thread only, see ThreadPool
+  unsigned mate = 0;     // stop once a mate in this many moves is found
+  unsigned soft_time = 0; // ms, no iteration is started after this
+  unsigned hard_time = 0; // ms, the search is aborted after this
+  bool infinite = false;
+  bool ponder = false;   // the clock only starts on ponderhit
+  MoveList search_moves; // root moves to search, every move if empty
+};
+
 class Search {
 public:
+  static PruningParameters pruning;
+
   // Constructor:
-  Search();
+  /*
+   * t_table and stop_flag are shared by every thread searching the position.
+   * Thread 0 is the main thread: it reports info and its best move is played.
+   * thread_pool is used to aggregate node counts and may be null.
+   */
+  Search(TTable &t_table, std::atomic<bool> &stop_flag, unsigned thread_id = 0,
+         ThreadPool *thread_pool = nullptr);
 
   // Getters:
   Move get_best_move();
+  inline uint64_t get_nodes_evaluated() {
+    return nodes_evaluated.load(std::memory_order_relaxed);
+  }
+
+  // Setters:
+  /*
+   * Clears the killer, history and counter-move tables.
+   */
+  void clear_heuristics();
 
   // Root:
   int alpha_beta_max_root(int alpha, int beta, int depth_left, Board &board,
@@ -42,23 +97,122 @@ public:
   // Iterative Deepening:
   int negamax_id(int depth, int alpha, int beta, Board &board,
                  MoveGenerator &move_gen, Evaluation &eval);
-  int negamax_root_iterative_deepening(unsigned time_limit, Board &board,
-                                       MoveGenerator &move_gen,
+  /*
+   * Deepens until the main thread reaches one of the limits or the stop flag
+   * is raised. The main thread raises the flag itself on the hard time and
+   * node limits; helper threads only stop on the flag. On a stop, best_move
+   * is the best move of the last completed iteration.
+   */
+  int negamax_root_iterative_deepening(const SearchLimits &search_limits,
+                                       Board &board, MoveGenerator &move_gen,
                                        Evaluation &eval);
+  /*
+   * Set before the search starts, so that a ponderhit sent right after is
+   * not lost.
+   */
+  inline void set_pondering(bool ponder) { pondering = ponder; }
+  /*
+   * Starts the clock of a pondering search. Safe to call from another thread.
+   */
+  inline void ponderhit() { pondering = false; }
+  inline bool is_pondering() { return pondering; }
   int quiescence_search(int alpha, int beta, Board &board,
                         MoveGenerator &move_gen, Evaluation &eval);
-  // TODO implement iterative deepening with time management
+  int aspiration_search(unsigned depth, int previous_score, Board &board,
+                        MoveGenerator &move_gen, Evaluation &eval);
+  int search_root(unsigned depth, int alpha, int beta, Board &board,
+                  MoveGenerator &move_gen, Evaluation &eval);
 private:
+  static const int INFINITE_SCORE = 999999;
+  static const int MATE_SCORE = 32000; // score of being mated at the root
+  // scores beyond are mates; mates pieced together from table entries can be
+  // much further away than MAX_PLY
+  static const int MATE_BOUND = MATE_SCORE - 1000;
+  static const int ASPIRATION_WINDOW = 50;
+  static const unsigned ASPIRATION_MIN_DEPTH = 4;
+  static const int NULL_MOVE_MIN_DEPTH = 3;
+  static const int NULL_MOVE_REDUCTION = 3;
+  static const int NULL_MOVE_VERIFICATION_DEPTH = 12;
+  static const int LMR_MIN_DEPTH = 3;
+  static const int LMR_MIN_MOVES = 3; // moves searched before reducing
+  static const int SINGULAR_MIN_DEPTH = 7;
+  static const int DELTA_MARGIN = 200; // positional slack for delta pruning
+  static const int SEE_PRUNING_MAX_DEPTH = 4;
+  static const int SEE_PRUNING_MARGIN = 100; // per ply of depth left
+  static const unsigned MAX_PLY = 64;
+  static const int MAX_HISTORY = 16384;
+  static const uint64_t NODES_PER_TIME_CHECK = 1024; // a power of two
+
+  unsigned thread_id;
+  ThreadPool *thread_pool;
+  std::atomic<bool> &stop_flag;
+  SearchLimits limits;
+  std::atomic<bool> pondering;
+  bool clock_started;
+  std::chrono::high_resolution_clock::time_point start_time;
+  bool should_stop();
+  unsigned get_time_passed();
+
   unsigned current_ply;
-  unsigned nodes_evaluated;
+  unsigned null_move_min_ply; // no null moves before this ply, see negamax_id
+  int root_depth;
+  int line_extensions;          // plies extended on the current line
+  Move excluded_moves[MAX_PLY]; // hash move left out by the singular test
+  // Only this thread writes its count, the others just read it to report
+  // the total, so counting needs no locked read-modify-write:
+  std::atomic<uint64_t> nodes_evaluated;
+  inline void count_node() {
+    nodes_evaluated.store(nodes_evaluated.load(std::memory_order_relaxed) + 1,
+                          std::memory_order_relaxed);
+  }
+  unsigned beta_cutoffs;
+  unsigned first_move_cutoffs; // beta cutoffs caused by the first move tried
 
   Move best_move;
-  TTable t_table;
+  TTable &t_table;
+  /*
+   * Mate scores count plies from the root, but the table is shared by every
+   * ply, so it keeps them counted from the stored position instead.
+   */
+  static inline int score_to_tt(int score, unsigned ply) {
+    return score >= MATE_BOUND    ? score + (int)ply
+           : score <= -MATE_BOUND ? score - (int)ply
+                                  : score;
+  }
+  static inline int score_from_tt(int score, unsigned ply) {
+    return score >= MATE_BOUND    ? score - (int)ply
+           : score <= -MATE_BOUND ? score + (int)ply
+                                  : score;
+  }
   PVTable pv_table;
 
+  bool is_null_move_allowed(int depth, int alpha, int beta, bool in_check,
+                            int static_eval, Board &board);
+
+  // Late move reductions:
+  static uint8_t lmr_reductions[64][64]; // [depth][move number]
+  static bool initialize_reductions();   // Called once by the first constructor
+  int get_reduction(int depth, int move_number, bool is_pv_node,
+                    bool gives_check, int history_score);
+
+  // Quiescence search pruning:
+  int get_capture_gain(Move &move, Board &board);
+
   // Move Ordering
-  static const uint8_t victim_aggressor_values[6][6]; // victim_aggressor_values[victim][attacker]
-  void sort_moves(MoveList& moves, Move& pv_move, Move& tt_move, Board& board);
+  void score_moves(MoveList &moves, ScoredMoveList &scored_moves,
+                   Move &pv_move, Move &tt_move, Board &board);
+
+  // Quiet move ordering heuristics, updated on beta cutoffs:
+  Move killer_moves[MAX_PLY][2];
+  int history[2][64][64];     // [color][origin index][destination index]
+  Move counter_moves[64][64]; // [origin index][destination index]
+  void update_quiet_heuristics(Board &board, Move &move, Move *quiets_tried,
+                               int quiets_tried_count, int depth);
+  void update_history(Color color, Move &move, int bonus);
+  void age_heuristics();
+
+  // Printers:
+  void print_info(unsigned depth, int score, unsigned time_passed);
 };
 
 #endif // GUARD
@@ -7,42 +7,143 @@
 
 #include "TTable.hpp"
 
+#include <assert.h>
+#include <cstdlib>
+#include <new>
+
 // TTEntry implementation:
-TTEntry::TTEntry() {}
-
-TTEntry::TTEntry(uint64_t zkey, TTEntryType::Value type, Move best_move,
-                 uint8_t depth, int score) {
-  this->zkey = zkey;
-  this->type = type;
-  this->best_move = best_move;
-  this->depth = depth;
-  this->score = score;
+TTEntry::TTEntry() : data(0) {}
+
+TTEntry::TTEntry(TTEntryType::Value type, Move best_move, uint8_t depth,
+                 int score, uint8_t generation) {
+  assert(score >= INT16_MIN && score <= INT16_MAX);
+  data = (uint64_t)best_move.get_move_rep() |
+         (uint64_t)(uint16_t)score << 16 | (uint64_t)depth << 32 |
+         (uint64_t)type << 40 | (uint64_t)generation << 42;
 }
 
+TTEntry::TTEntry(uint64_t data) : data(data) {}
+
 // TTable implementation:
-Move empty_move;
-TTEntry empty_entry(0, TTEntryType::Value::NONE, empty_move, 0, 0);
+TTable::TTable(size_t size_mb) : memory(nullptr), generation(0) {
+  static_assert(sizeof(TTCluster) == CACHE_LINE_SIZE,
+                "TTCluster should fill a cache line");
+  resize(size_mb);
+}
 
-TTable::TTable() {}
+TTable::~TTable() { free(memory); }
 
-TTEntry &TTable::probe_entry(uint64_t zkey, unsigned depth) {
-  uint64_t index = zkey % size;
-  if (t_table[index].get_type() != TTEntryType::Value::NONE &&
-      t_table[index].get_zkey() == zkey &&
-      t_table[index].get_depth() >= depth) {
-    return t_table[index];
+TTEntry TTable::probe_entry(uint64_t zkey, unsigned depth) {
+  TTCluster &cluster = get_cluster(zkey);
+  for (unsigned i = 0; i < CLUSTER_SIZE; i++) {
+    TTSlot &slot = cluster.slots[i];
+    uint64_t data = slot.data.load(std::memory_order_relaxed);
+    uint64_t key_xor_data = slot.key_xor_data.load(std::memory_order_relaxed);
+    TTEntry entry(data);
+    if ((key_xor_data ^ data) == zkey &&
+        entry.get_type() != TTEntryType::Value::NONE) {
+      return entry.get_depth() >= depth ? entry : TTEntry();
+    }
   }
-  return empty_entry;
+  return TTEntry();
 }
 
 void TTable::set_entry(uint64_t zkey, int depth, TTEntryType::Value type,
                        Move best_move, int score) {
-  uint64_t index = zkey % size;
-  if (t_table[index].get_type() == TTEntryType::Value::NONE ||
-      depth >= t_table[index].get_depth()) {
-    TTEntry new_entry(zkey, type, best_move, depth, score);
-    t_table[index] = new_entry;
+  TTCluster &cluster = get_cluster(zkey);
+
+  TTSlot *replace = &cluster.slots[0];
+  TTEntry replace_entry(replace->data.load(std::memory_order_relaxed));
+  for (unsigned i = 0; i < CLUSTER_SIZE; i++) {
+    TTSlot &slot = cluster.slots[i];
+    uint64_t data = slot.data.load(std::memory_order_relaxed);
+    uint64_t key_xor_data = slot.key_xor_data.load(std::memory_order_relaxed);
+    TTEntry entry(data);
+    if (entry.get_type() != TTEntryType::Value::NONE &&
+        (key_xor_data ^ data) == zkey) {
+      // a shallow store, such as one from quiescence, keeps a deeper entry
+      // from this search unless it is exact
+      if (type != TTEntryType::Value::EXACT && get_age(entry) == 0 &&
+          depth + SAME_KEY_DEPTH_MARGIN < entry.get_depth()) {
+        return;
+      }
+      // keep the old best move rather than forget it
+      if (best_move.is_null()) {
+        best_move = entry.get_best_move();
+      }
+      replace = &slot;
+      break;
+    }
+    if (entry.get_type() == TTEntryType::Value::NONE) {
+      replace = &slot;
+      break;
+    }
+    if (entry.get_depth() - 8 * (int)get_age(entry) <
+        replace_entry.get_depth() - 8 * (int)get_age(replace_entry)) {
+      replace = &slot;
+      replace_entry = entry;
+    }
   }
+
+  TTEntry new_entry(type, best_move, depth, score, generation);
+  uint64_t data = new_entry.get_data();
+  replace->key_xor_data.store(zkey ^ data, std::memory_order_relaxed);
+  replace->data.store(data, std::memory_order_relaxed);
+}
+
+void TTable::new_search() { generation = (generation + 1) % GENERATION_COUNT; }
+
+size_t TTable::resize(size_t size_mb) {
+  // the old table is only freed once the new one is allocated, and a size
+  // the machine cannot supply is halved until it can
+  for (; size_mb > 0; size_mb /= 2) {
+    uint64_t max_clusters = ((uint64_t)size_mb << 20) / sizeof(TTCluster);
+    assert(max_clusters > 0);
+    uint64_t new_size = 1;
+    while (new_size * 2 <= max_clusters) {
+      new_size *= 2;
+    }
+
+    void *new_memory =
+        malloc(new_size * sizeof(TTCluster) + CACHE_LINE_SIZE - 1);
+    if (new_memory == nullptr) {
+      continue;
+    }
+    free(memory);
+    memory = new_memory;
+    size = new_size;
+    index_mask = size - 1;
+    uintptr_t aligned =
+        ((uintptr_t)memory + CACHE_LINE_SIZE - 1) & ~(CACHE_LINE_SIZE - 1);
+    t_table = (TTCluster *)aligned;
+    // the clusters hold only atomics, which need no destruction, so they are
+    // constructed here and simply freed with the memory
+    for (uint64_t i = 0; i < size; i++) {
+      new (&t_table[i]) TTCluster();
+    }
+    clear();
+    return size_mb;
+  }
+
+  // not even 1 MiB is free, so the old table is kept
+  assert(memory != nullptr);
+  return 0;
+}
+
+void TTable::clear() {
+  for (uint64_t i = 0; i < size; i++) {
+    for (unsigned j = 0; j < CLUSTER_SIZE; j++) {
+      t_table[i].slots[j].key_xor_data.store(0, std::memory_order_relaxed);
+      t_table[i].slots[j].data.store(0, std::memory_order_relaxed);
+    }
+  }
+  generation = 0;
+}
+
+// Number of searches since the entry was stored.
+unsigned TTable::get_age(TTEntry &entry) {
+  return (GENERATION_COUNT + generation - entry.get_generation()) %
+         GENERATION_COUNT;
 }
 
 #endif // GUARD
@@ -8,41 +8,117 @@
 
 #include "Move.hpp"
 
+#include <atomic>
+#include <cstddef>
+
 namespace TTEntryType {
 enum Value { NONE = 0, EXACT = 1, LOWER = 2, UPPER = 3 };
 };
 
+/*
+ * An entry packed into 64 bits:
+ * bits 0-15 the best move, 16-31 the score, 32-39 the depth,
+ * 40-41 the bound type and 42-47 the generation of the search which stored it.
+ */
 class TTEntry {
 public:
   TTEntry();
-  TTEntry(uint64_t zkey, TTEntryType::Value type, Move best_move, uint8_t depth,
-          int score);
+  TTEntry(TTEntryType::Value type, Move best_move, uint8_t depth, int score,
+          uint8_t generation);
+  explicit TTEntry(uint64_t data);
 
-  inline uint64_t get_zkey() { return zkey; }
-  inline TTEntryType::Value get_type() { return type; }
-  inline Move get_best_move() { return best_move; }
-  inline uint8_t get_depth() { return depth; }
-  inline int get_score() { return score; }
+  inline uint64_t get_data() { return data; }
+  inline TTEntryType::Value get_type() {
+    return (TTEntryType::Value)((data >> 40) & 0x3);
+  }
+  inline Move get_best_move() { return Move((uint16_t)data); }
+  inline uint8_t get_depth() { return data >> 32; }
+  inline int get_score() { return (int16_t)(data >> 16); }
+  inline uint8_t get_generation() { return (data >> 42) & 0x3F; }
 
 private:
-  uint64_t zkey;
-  TTEntryType::Value type;
-  Move best_move;
-  uint8_t depth;
-  int score;
+  uint64_t data;
 };
 
-// hardcode to 1024 entries for now
+/*
+ * The table is an array of 64 byte clusters of four entries, so a probe reads
+ * a single cache line. There is a power of two number of clusters, so that a
+ * cluster is found by masking the key rather than with a modulo.
+ *
+ * Threads probe and store without locking. Each slot holds the entry's data
+ * and the zobrist key xor the data, as two atomic words. A probe only accepts
+ * a slot if the two words xor back to the key, so an entry torn by concurrent
+ * stores is read as a miss rather than as another position's data.
+ */
 class TTable {
 public:
-  TTable();
-  TTEntry &probe_entry(uint64_t zkey, unsigned depth);
+  static const size_t DEFAULT_SIZE_MB = 16;
+
+  TTable(size_t size_mb = DEFAULT_SIZE_MB);
+  ~TTable();
+  TTable(const TTable &) = delete;
+  TTable &operator=(const TTable &) = delete;
+
+  /*
+   * Returns the entry for zkey if it is at least depth deep, and an entry of
+   * type NONE otherwise.
+   */
+  TTEntry probe_entry(uint64_t zkey, unsigned depth);
+
+  /*
+   * Stores over the entry for zkey if the cluster has one, otherwise over the
+   * entry with the lowest depth minus eight times its age in searches.
+   * An entry for zkey from the current search is only overwritten by an exact
+   * result or one at most SAME_KEY_DEPTH_MARGIN plies shallower.
+   */
   void set_entry(uint64_t zkey, int depth, TTEntryType::Value type,
                  Move best_move, int score);
 
+  /*
+   * Bumps the generation, aging every entry stored by earlier searches.
+   */
+  void new_search();
+
+  /*
+   * Reallocates the table with as many clusters as fit in size_mb MiB, or in
+   * the largest half, quarter and so on of it that can be allocated. Returns
+   * the MiB used, or 0 if nothing could be allocated and the old table is
+   * kept. The contents are lost unless the old table is kept.
+   */
+  size_t resize(size_t size_mb);
+
+  /*
+   * Empties every entry.
+   */
+  void clear();
+
+  inline uint64_t get_size() { return size; }
+
 private:
-  static const unsigned size = 4096;
-  TTEntry t_table[4096];
+  static const size_t CACHE_LINE_SIZE = 64;
+  static const unsigned CLUSTER_SIZE = 4;
+  static const unsigned GENERATION_COUNT = 64; // fits in the 6 bits stored
+  static const int SAME_KEY_DEPTH_MARGIN = 3;
+
+  struct TTSlot {
+    std::atomic<uint64_t> key_xor_data;
+    std::atomic<uint64_t> data;
+  };
+
+  struct TTCluster {
+    TTSlot slots[CLUSTER_SIZE];
+  };
+
+  void *memory; // allocation holding the cache line aligned t_table
+  TTCluster *t_table;
+  uint64_t size; // number of clusters
+  uint64_t index_mask;
+  uint8_t generation;
+
+  inline TTCluster &get_cluster(uint64_t zkey) {
+    return t_table[zkey & index_mask];
+  }
+  unsigned get_age(TTEntry &entry);
 };
 
 #endif // GUARD
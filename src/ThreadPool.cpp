@@ -0,0 +1,131 @@
+/*
+ * ThreadPool implementation.
+ */
+
+#ifndef THREAD_POOL_CPP // GUARD
+#define THREAD_POOL_CPP // GUARD
+
+#include "ThreadPool.hpp"
+#include "MoveGenerator.hpp"
+
+#include <assert.h>
+#include <chrono>
+#include <thread>
+
+// Constructor:
+ThreadPool::ThreadPool() {
+  stop_flag = false;
+  active_thread_count = 0;
+  set_thread_count(1);
+}
+
+ThreadPool::~ThreadPool() { stop(); }
+
+// Getters:
+uint64_t ThreadPool::get_nodes_evaluated() {
+  uint64_t nodes = 0;
+  // threads left out of the last search still hold the counts of an
+  // earlier one
+  for (size_t i = 0; i < active_thread_count; i++) {
+    nodes += searches[i]->get_nodes_evaluated();
+  }
+  return nodes;
+}
+
+// Setters:
+void ThreadPool::set_thread_count(unsigned thread_count) {
+  assert(thread_count > 0);
+  active_thread_count = 0;
+  searches.clear();
+  evaluations.clear();
+  for (unsigned i = 0; i < thread_count; i++) {
+    searches.push_back(
+        std::unique_ptr<Search>(new Search(t_table, stop_flag, i, this)));
+    evaluations.push_back(std::unique_ptr<Evaluation>(new Evaluation()));
+  }
+}
+
+void ThreadPool::clear() {
+  t_table.clear();
+  for (size_t i = 0; i < searches.size(); i++) {
+    searches[i]->clear_heuristics();
+    evaluations[i]->clear();
+  }
+}
+
+Move ThreadPool::search(const SearchLimits &limits, const Board &board) {
+  stop_flag = false;
+  searches[0]->set_pondering(limits.ponder);
+  return run_search(limits, board);
+}
+
+void ThreadPool::start_search(const SearchLimits &limits, const Board &board,
+                              std::function<void(Move)> report) {
+  stop();
+  // set here rather than on the search thread, so that a stop or a
+  // ponderhit sent right after is not lost
+  stop_flag = false;
+  searches[0]->set_pondering(limits.ponder);
+  main_thread = std::thread([this, limits, board, report]() {
+    report(run_search(limits, board));
+  });
+}
+
+void ThreadPool::ponderhit() { searches[0]->ponderhit(); }
+
+void ThreadPool::stop() {
+  stop_flag = true;
+  if (main_thread.joinable()) {
+    main_thread.join();
+  }
+}
+
+// Helpers:
+// Searches with the stop flag already cleared by the caller.
+Move ThreadPool::run_search(const SearchLimits &limits, const Board &board) {
+  // node limited searches start from a clean table and clean heuristics and
+  // run on the main thread alone, so that searching the same position with
+  // the same limit always gives the same result
+  if (limits.nodes) {
+    clear();
+  }
+  t_table.new_search();
+
+  active_thread_count = limits.nodes ? 1 : searches.size();
+  std::vector<std::thread> helpers;
+  for (size_t i = 1; i < active_thread_count; i++) {
+    Search *helper = searches[i].get();
+    Evaluation *helper_eval = evaluations[i].get();
+    // each helper searches its own copy of the board
+    Board helper_board = board;
+    helpers.push_back(
+        std::thread([helper, helper_eval, &limits, helper_board]() mutable {
+          MoveGenerator move_gen;
+          helper->negamax_root_iterative_deepening(limits, helper_board,
+                                                   move_gen, *helper_eval);
+        }));
+  }
+
+  // the main thread searches its own copy as well
+  Board main_board = board;
+  MoveGenerator move_gen;
+  searches[0]->negamax_root_iterative_deepening(limits, main_board, move_gen,
+                                                *evaluations[0]);
+
+  // the best move of an infinite or pondering search is only reported once
+  // the GUI asks for it, even if the search has nothing left to do
+  while ((limits.infinite || searches[0]->is_pondering()) &&
+         !stop_flag.load()) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+
+  // the main thread decides when the search is over
+  stop_flag = true;
+  for (size_t i = 0; i < helpers.size(); i++) {
+    helpers[i].join();
+  }
+
+  return searches[0]->get_best_move();
+}
+
+#endif // GUARD
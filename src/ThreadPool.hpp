@@ -0,0 +1,86 @@
+/*
+ * ThreadPool class.
+ * Lazy SMP: every thread searches the same root position with its own board,
+ * search stack and move ordering tables. The threads only share the
+ * transposition table, so a thread that finishes an iteration first hands its
+ * results to the others through it.
+ */
+
+#ifndef THREAD_POOL_HPP // GUARD
+#define THREAD_POOL_HPP // GUARD
+
+#include "Board.hpp"
+#include "Evaluation.hpp"
+#include "Search.hpp"
+#include "TTable.hpp"
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+class ThreadPool {
+public:
+  // Constructor:
+  ThreadPool();
+  ~ThreadPool();
+
+  // Getters:
+  inline unsigned get_thread_count() { return searches.size(); }
+  /*
+   * Nodes evaluated by the threads of the running or last search.
+   */
+  uint64_t get_nodes_evaluated();
+
+  // Setters:
+  void set_thread_count(unsigned thread_count);
+  inline size_t set_hash_size(size_t size_mb) {
+    return t_table.resize(size_mb);
+  }
+
+  /*
+   * Forgets everything learnt from previous searches, pawn tables included.
+   */
+  void clear();
+
+  /*
+   * Searches a copy of board on every thread within limits and returns the
+   * best move found by the main thread. Node limited searches use the main
+   * thread only and forget earlier searches first, so that they are
+   * reproducible.
+   */
+  Move search(const SearchLimits &limits, const Board &board);
+
+  /*
+   * Like search, but runs on a thread of its own and returns at once.
+   * report is called on that thread with the best move when the search is
+   * over. A search already running is stopped first.
+   */
+  void start_search(const SearchLimits &limits, const Board &board,
+                    std::function<void(Move)> report);
+
+  /*
+   * Switches a pondering search to normal time management.
+   */
+  void ponderhit();
+
+  /*
+   * Stops a search started with start_search and waits for it to report.
+   */
+  void stop();
+
+private:
+  TTable t_table;
+  std::atomic<bool> stop_flag;
+  std::vector<std::unique_ptr<Search>> searches;
+  size_t active_thread_count; // searches used by the last search
+  // one per search, kept between searches so the pawn tables stay warm
+  std::vector<std::unique_ptr<Evaluation>> evaluations;
+
+  std::thread main_thread; // runs the main search of start_search
+
+  Move run_search(const SearchLimits &limits, const Board &board);
+};
+
+#endif // GUARD
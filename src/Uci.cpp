@@ -5,11 +5,31 @@
 #include "Uci.hpp"
 #include <iostream>
 #include <sstream>
-#include <thread>
 
 #ifndef UCI_CPP // GUARD
 #define UCI_CPP // GUARD
 
+// Search parameters exposed as spin options for tuning.
+struct TunableOption {
+  const char *name;
+  int *value;
+  int min;
+  int max;
+};
+
+static const TunableOption tunable_options[] = {
+    {"ReverseFutilityMargin", &Search::pruning.reverse_futility_margin, 0,
+     1000},
+    {"ReverseFutilityDepth", &Search::pruning.reverse_futility_max_depth, 0,
+     20},
+    {"FutilityMargin", &Search::pruning.futility_margin, 0, 1000},
+    {"FutilityDepth", &Search::pruning.futility_max_depth, 0, 20},
+    {"RazoringMargin", &Search::pruning.razoring_margin, 0, 2000},
+    {"RazoringDepth", &Search::pruning.razoring_max_depth, 0, 20},
+    {"LateMovePruningBase", &Search::pruning.late_move_pruning_base, 0, 100},
+    {"LateMovePruningDepth", &Search::pruning.late_move_pruning_max_depth, 0,
+     20}};
+
 Uci::Uci() {}
 
 void Uci::loop() {
@@ -21,25 +41,76 @@ void Uci::loop() {
     token.clear();
     input >> std::skipws >> token;
 
+    // the board, the tables and the options may only change once the
+    // search thread is done with them
+    if (token == "setoption" || token == "ucinewgame" || token == "position" ||
+        token == "go" || token == "quit") {
+      engine.stop();
+    }
+
     if (token == "uci") {
       std::cout << "id name ellis-engine" << std::endl;
       std::cout << "id author Ellis McDougald" << std::endl;
-      // TODO: optional options
+      std::cout << "option name Threads type spin default 1 min 1 max "
+                << MAX_THREADS << std::endl;
+      std::cout << "option name Hash type spin default "
+                << TTable::DEFAULT_SIZE_MB << " min 1 max " << MAX_HASH_MB
+                << std::endl;
+      for (const TunableOption &option : tunable_options) {
+        std::cout << "option name " << option.name << " type spin default "
+                  << *option.value << " min " << option.min << " max "
+                  << option.max << std::endl;
+      }
       std::cout << "uciok" << std::endl;
+    } else if (token == "setoption") {
+      std::string name;
+      unsigned value;
+      input >> token >> name >> token >> value; // name <name> value <value>
+      if (name == "Threads" && value >= 1 && value <= MAX_THREADS) {
+        engine.set_thread_count(value);
+      } else if (name == "Hash" && value >= 1 && value <= MAX_HASH_MB) {
+        size_t hash_mb = engine.set_hash_size(value);
+        if (hash_mb == 0) {
+          std::cout << "info string could not allocate a hash table, keeping "
+                       "the previous one"
+                    << std::endl;
+        } else if (hash_mb != value) {
+          std::cout << "info string could not allocate " << value
+                    << " MB of hash, using " << hash_mb << " MB" << std::endl;
+        }
+      }
+      for (const TunableOption &option : tunable_options) {
+        if (name == option.name && (int)value >= option.min &&
+            (int)value <= option.max) {
+          *option.value = value;
+        }
+      }
+    } else if (token == "ucinewgame") {
+      engine.start_new_game();
+    } else if (token == "stop") {
+      engine.stop();
+    } else if (token == "ponderhit") {
+      engine.ponderhit();
     } else if (token == "isready") {
       std::cout << "readyok" << std::endl;
+    } else if (token == "quit") {
+      break;
     } else if (token == "position") {
       input >> token;
       if (token == "startpos") {
         std::string start_pos_fen =
             "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
         engine.set_position(start_pos_fen);
-      } else if (token == "fen") {
         input >> token;
-        engine.set_position(token);
+      } else if (token == "fen") {
+        // the fen runs up to the move list, if any
+        std::string fen;
+        while (input >> token && token != "moves") {
+          fen += fen.empty() ? token : " " + token;
+        }
+        engine.set_position(fen);
       }
 
-      input >> token;
       if (token == "moves") {
         while (input >> token) {
           engine.play_move(token);
@@ -48,26 +119,69 @@ void Uci::loop() {
     } else if (token == "show") {
       engine.show_board();
     } else if (token == "go") {
-      unsigned val;
-      while (input >> token) {
-        input >> val;
-        if (token == "wtime") {
-          engine.set_white_time(val);
-        } else if (token == "btime") {
-          engine.set_black_time(val);
-        } else if (token == "winc") {
-          engine.set_white_increment(val);
-        } else if (token == "binc") {
-          engine.set_black_increment(val);
-        } else if (token == "movestogo") {
-          engine.set_moves_to_go(val);
+      SearchLimits limits;
+      engine.clear_time_control();
+      uint64_t val;
+      input >> token;
+      while (input) {
+        if (token == "infinite") {
+          limits.infinite = true;
+        } else if (token == "ponder") {
+          limits.ponder = true;
+        } else if (token == "searchmoves") {
+          while (input >> token && !is_go_parameter(token)) {
+            Move move = engine.get_legal_move(token);
+            if (!move.is_null()) {
+              limits.search_moves.add_move(move);
+            }
+          }
+          continue; // token is the next parameter, if any
+        } else if (!is_go_parameter(token)) {
+          // unknown tokens are ignored
+        } else if (!(input >> val)) {
+          // the value is missing: what stands in its place is read as the
+          // next token
+          input.clear();
+        } else {
+          if (token == "wtime") {
+            engine.set_white_time(val);
+          } else if (token == "btime") {
+            engine.set_black_time(val);
+          } else if (token == "winc") {
+            engine.set_white_increment(val);
+          } else if (token == "binc") {
+            engine.set_black_increment(val);
+          } else if (token == "movestogo") {
+            engine.set_moves_to_go(val);
+          } else if (token == "depth") {
+            limits.depth = val;
+          } else if (token == "nodes") {
+            limits.nodes = val;
+          } else if (token == "mate") {
+            limits.mate = val;
+          } else if (token == "movetime") {
+            limits.soft_time = val;
+            limits.hard_time = val;
+          }
         }
+        input >> token;
       }
-      // start search on another thread
-      std::thread search_thread([this]() { search(); });
-      search_thread.detach();
+      search(limits); // returns while the search runs on another thread
+    }
+  }
+  engine.stop();
+}
+
+bool Uci::is_go_parameter(std::string &token) {
+  static const char *parameters[] = {
+      "searchmoves", "ponder", "wtime", "btime", "winc",    "binc",
+      "movestogo",   "depth",  "nodes", "mate",  "movetime", "infinite"};
+  for (const char *parameter : parameters) {
+    if (token == parameter) {
+      return true;
     }
   }
+  return false;
 }
 
 #endif // GUARD
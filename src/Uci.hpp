@@ -15,9 +15,13 @@ public:
   void loop();
 
 private:
+  static const unsigned MAX_THREADS = 256;
+  static const unsigned MAX_HASH_MB = 65536;
+
   Engine engine;
 
-  inline void search() { engine.search_best_move(); }
+  inline void search(SearchLimits limits) { engine.search_best_move(limits); }
+  bool is_go_parameter(std::string &token);
 };
 
 #endif
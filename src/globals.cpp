@@ -3,33 +3,15 @@
 #ifndef GLOBALS_CPP // GUARD
 #define GLOBALS_CPP
 
+// Square index = row * 8 + (7 - col), since bit 0 is h1 and bit 7 is a1.
 uint64_t get_position_from_row_col(uint8_t row, uint8_t col) {
-  uint64_t position = 1;
-
-  for (char row_index = 0; row_index < row; row_index++) {
-    position <<= 8;
-  }
-
-  for (char col_index = 7; col_index > col; col_index--) {
-    position <<= 1;
-  }
-
-  return position;
+  return ((uint64_t)1) << (((row & 7) << 3) + ((7 - col) & 7));
 }
 
 bitboard position_string_to_bitboard(std::string position_str) {
-  char col = 7 - (position_str[0] - 'a');
-  char row = position_str[1] - '0' - 1;
-
-  bitboard position = 1;
-  for (char row_index = 0; row_index < row; row_index++) {
-    position <<= 8;
-  }
-  for (char col_index = 0; col_index < col; col_index++) {
-    position <<= 1;
-  }
-
-  return position;
+  int col = position_str[0] - 'a';
+  int row = position_str[1] - '1';
+  return ((bitboard)1) << ((row << 3) + (7 - col));
 }
 
 void print_bitboard(bitboard bb) {
@@ -64,7 +64,7 @@ void print_bitboard(bitboard bb);
 bitboard position_string_to_bitboard(std::string position_str);
 
 // https://chessprogramming.wikispaces.com/Population+Count
-inline unsigned popcount(bitboard bb) { return __builtin_popcount(bb); }
+inline unsigned popcount(bitboard bb) { return __builtin_popcountll(bb); }
 
 inline int lsb(bitboard bb) { return __builtin_ctzl(bb); }
 
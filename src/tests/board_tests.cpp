@@ -2,7 +2,9 @@
 #define BOARD_TESTS_CPP
 
 #include "iostream"
+#include <catch2/benchmark/catch_benchmark.hpp>
 #include <catch2/catch_test_macros.hpp>
+#include <map>
 
 #include "../Board.hpp"
 
@@ -82,6 +84,14 @@ TEST_CASE("test inititalize_fen") {
     REQUIRE(board.get_half_moves() == 0);
     REQUIRE(board.get_full_moves() == 1);
   }
+
+  SECTION("fen without castle rights") {
+    board.initialize_fen("r3k2r/8/8/8/8/8/8/R3K2R w - - 0 1");
+    REQUIRE(!board.get_can_castle_king(WHITE));
+    REQUIRE(!board.get_can_castle_queen(WHITE));
+    REQUIRE(!board.get_can_castle_king(BLACK));
+    REQUIRE(!board.get_can_castle_queen(BLACK));
+  }
 }
 
 TEST_CASE("Test set_piece_positions", "[set_piece_positions]") {
@@ -769,4 +779,204 @@ TEST_CASE("test is_move_legal") {
   }
 }
 
+TEST_CASE("test null move") {
+  Board board;
+  board.initialize_board_starting_position();
+  Move double_push('e', 2, 'e', 4, 1);
+  board.execute_move(double_push);
+  Move black_double_push('d', 7, 'd', 5, 1);
+  board.execute_move(black_double_push);
+  Move advance('e', 4, 'e', 5, 0);
+  board.execute_move(advance);
+  Move en_passant_push('f', 7, 'f', 5, 1);
+  board.execute_move(en_passant_push);
+
+  uint64_t zkey = board.get_zkey();
+  board.make_null_move();
+
+  REQUIRE(board.get_turn_color() == BLACK);
+  REQUIRE(board.get_zkey() != zkey);
+  REQUIRE(board.get_zkey() == board.generate_zkey());
+
+  board.undo_null_move();
+
+  REQUIRE(board.get_turn_color() == WHITE);
+  REQUIRE(board.get_zkey() == zkey);
+  Move last_move = board.get_last_move(BLACK);
+  REQUIRE(last_move.move_equals(en_passant_push));
+}
+
+TEST_CASE("test square conversions") {
+  Board board;
+
+  for (int square_index = 0; square_index < 64; ++square_index) {
+    bitboard square = ((bitboard)1) << square_index;
+    REQUIRE(board.get_square(square_index) == square);
+    REQUIRE(board.get_square_index(square) == square_index);
+  }
+  REQUIRE(position_string_to_bitboard("a1") == 0x80);
+  REQUIRE(position_string_to_bitboard("h8") == 0x100000000000000);
+  REQUIRE(get_position_from_row_col(3, 3) == position_string_to_bitboard("d4"));
+}
+
+TEST_CASE("test draw detection") {
+  Board board;
+
+  SECTION("repetition") {
+    board.initialize_board_starting_position();
+    Move knight_out('g', 1, 'f', 3, 0);
+    Move black_knight_out('g', 8, 'f', 6, 0);
+    Move knight_back('f', 3, 'g', 1, 0);
+    Move black_knight_back('f', 6, 'g', 8, 0);
+    board.execute_move(knight_out);
+    board.execute_move(black_knight_out);
+    board.execute_move(knight_back);
+    REQUIRE(!board.is_repetition());
+    board.execute_move(black_knight_back);
+    REQUIRE(board.is_repetition());
+    REQUIRE(board.is_draw());
+    board.undo_move(black_knight_back);
+    REQUIRE(!board.is_repetition());
+  }
+
+  SECTION("upcoming repetition") {
+    int cuckoo_entries = 0;
+    for (int i = 0; i < Board::CUCKOO_SIZE; i++) {
+      cuckoo_entries += Board::cuckoo_moves[i] != 0;
+    }
+    REQUIRE(cuckoo_entries == 3668); // reversible moves on an empty board
+
+    board.initialize_board_starting_position();
+    Move knight_out('g', 1, 'f', 3, 0);
+    Move black_knight_out('g', 8, 'f', 6, 0);
+    Move knight_back('f', 3, 'g', 1, 0);
+    board.execute_move(knight_out);
+    board.execute_move(black_knight_out);
+    REQUIRE(!board.has_upcoming_repetition(64));
+    board.execute_move(knight_back);
+    // Ng8 would repeat the starting position
+    REQUIRE(board.has_upcoming_repetition(64));
+    REQUIRE(!board.has_upcoming_repetition(3)); // the cycle began before ply 0
+  }
+
+  SECTION("games longer than the history") {
+    board.initialize_board_starting_position();
+    Move shuffle[4] = {Move('g', 1, 'f', 3, 0), Move('g', 8, 'f', 6, 0),
+                       Move('f', 3, 'g', 1, 0), Move('f', 6, 'g', 8, 0)};
+    for (int i = 0; i < 1200; i++) {
+      board.execute_move(shuffle[i % 4]);
+    }
+    REQUIRE(board.is_repetition());
+
+    uint64_t zkey = board.get_zkey();
+    Move pawn_push('e', 2, 'e', 4, 1);
+    board.execute_move(pawn_push);
+    REQUIRE(!board.is_repetition());
+    board.undo_move(pawn_push);
+    REQUIRE(board.get_zkey() == zkey);
+    REQUIRE(board.get_last_move(BLACK).move_equals(shuffle[3]));
+    REQUIRE(board.is_repetition());
+  }
+
+  SECTION("fifty-move rule") {
+    board.initialize_fen("4k3/8/8/8/8/8/4P3/4K3 w - - 99 80");
+    REQUIRE(!board.is_draw());
+    Move king_move('e', 1, 'd', 1, 0);
+    board.execute_move(king_move);
+    REQUIRE(board.is_draw());
+    board.undo_move(king_move);
+    Move pawn_push('e', 2, 'e', 3, 0);
+    board.execute_move(pawn_push);
+    REQUIRE(!board.is_draw());
+  }
+
+  SECTION("mate on the hundredth half-move") {
+    board.initialize_fen("6k1/5ppp/8/8/8/8/8/R5K1 w - - 99 80");
+    Move back_rank_mate('a', 1, 'a', 8, 0);
+    board.execute_move(back_rank_mate);
+    REQUIRE(board.get_half_moves() == 100);
+    REQUIRE(board.is_checkmate());
+    REQUIRE(!board.is_draw());
+
+    // with an escape square it is only check, and the rule applies
+    board.initialize_fen("6k1/5pp1/8/8/8/8/8/R5K1 w - - 99 80");
+    board.execute_move(back_rank_mate);
+    REQUIRE(!board.is_checkmate());
+    REQUIRE(board.is_draw());
+  }
+}
+
+TEST_CASE("test static exchange evaluation") {
+  Board board;
+
+  SECTION("undefended pawn") {
+    board.initialize_fen("1k1r4/1pp4p/p7/4p3/8/P5P1/1PP4P/2K1R3 w - - 0 1");
+    Move move('e', 1, 'e', 5, 4);
+    REQUIRE(board.see(move) == 100);
+    REQUIRE(board.see_ge(move, 100));
+    REQUIRE(!board.see_ge(move, 101));
+  }
+
+  SECTION("pawn defended by a pawn") {
+    board.initialize_fen("4k3/8/3p4/4p3/8/8/8/4Q1K1 w - - 0 1");
+    Move move('e', 1, 'e', 5, 4);
+    REQUIRE(board.see(move) == -800);
+    REQUIRE(!board.see_ge(move, 0));
+  }
+
+  SECTION("x-ray through the capturing rook") {
+    board.initialize_fen("4r1k1/8/8/4p3/8/8/4R3/4R1K1 w - - 0 1");
+    Move move('e', 2, 'e', 5, 4);
+    REQUIRE(board.see(move) == 100);
+    REQUIRE(board.see_ge(move, 0));
+  }
+
+  SECTION("en passant") {
+    board.initialize_fen("4k3/8/8/3Pp3/8/8/8/4K3 w - e6 0 1");
+    Move move('d', 5, 'e', 6, 5);
+    REQUIRE(board.see(move) == 100);
+  }
+}
+
+// Run with: ./board_tests "[benchmark]"
+TEST_CASE("benchmark square conversions", "[.][benchmark]") {
+  Board board;
+  board.set_piece(KING, WHITE, position_string_to_bitboard("e1"));
+  board.set_piece(ROOK, WHITE, position_string_to_bitboard("h1"));
+  board.set_piece(PAWN, WHITE, position_string_to_bitboard("c3"));
+  board.set_piece(BISHOP, BLACK, position_string_to_bitboard("b4"));
+  board.set_piece(ROOK, BLACK, position_string_to_bitboard("d8"));
+
+  // The lookups Board used before square conversions became bit arithmetic.
+  std::map<int, bitboard> square_lookup;
+  std::map<bitboard, int> square_index_lookup;
+  for (int square_index = 0; square_index < 64; ++square_index) {
+    square_lookup[square_index] = ((bitboard)1) << square_index;
+    square_index_lookup[((bitboard)1) << square_index] = square_index;
+  }
+
+  BENCHMARK("std::map square round trips") {
+    int total = 0;
+    for (int square_index = 0; square_index < 64; ++square_index) {
+      total += square_index_lookup[square_lookup[square_index]];
+    }
+    return total;
+  };
+
+  BENCHMARK("bit arithmetic square round trips") {
+    int total = 0;
+    for (int square_index = 0; square_index < 64; ++square_index) {
+      total += board.get_square_index(board.get_square(square_index));
+    }
+    return total;
+  };
+
+  BENCHMARK("is_move_legal") {
+    Move move('c', 3, 'b', 4, 4);
+    return board.is_move_legal(move, WHITE);
+  };
+
+  BENCHMARK("Board construction") { return Board().get_zkey(); };
+}
+
 #endif
@@ -5,6 +5,7 @@
 #include <catch2/catch_test_macros.hpp>
 
 #include "../Evaluation.hpp"
+#include "../MoveGenerator.hpp"
 
 TEST_CASE("Test") {
   Evaluation eval;
@@ -23,10 +24,130 @@ TEST_CASE("Test") {
 
   SECTION("pawns only") {
     board.set_piece_positions(PAWN, WHITE, 0xFF00);
-    REQUIRE(eval.evaluate(board) == 810);
+    REQUIRE(eval.evaluate(board) == 968);
 
     board.set_piece_positions(PAWN, WHITE, 0xEF00);
-    REQUIRE(eval.evaluate(board) == 730);
+    REQUIRE(eval.evaluate(board) == 847);
+  }
+}
+
+TEST_CASE("tapered evaluation") {
+  Evaluation eval;
+  Board board;
+
+  SECTION("game phase") {
+    board.initialize_board_starting_position();
+    REQUIRE(board.get_phase() == Evaluation::MAX_PHASE);
+
+    board.initialize_fen("4k3/pppppppp/8/8/8/8/PPPPPPPP/4K3 w - - 0 1");
+    REQUIRE(board.get_phase() == 0);
+
+    board.initialize_fen("r3k3/pppppppp/8/8/8/8/PPPPPPPP/3QK3 w - - 0 1");
+    REQUIRE(board.get_phase() == 6);
+  }
+
+  SECTION("king shelters in the midgame") {
+    board.initialize_fen(
+        "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQ1BKR w - - 0 1");
+    int castled = eval.evaluate(board);
+    board.initialize_fen(
+        "rnbqkbnr/pppppppp/8/8/8/4K3/PPPPPPPP/RNBQ1B1R w - - 0 1");
+    REQUIRE(castled > eval.evaluate(board));
+  }
+
+  SECTION("king centralizes in the endgame") {
+    board.initialize_fen("4k3/pppppppp/8/8/8/8/PPPPPPPP/6K1 w - - 0 1");
+    int castled = eval.evaluate(board);
+    board.initialize_fen("4k3/pppppppp/8/8/8/4K3/PPPPPPPP/8 w - - 0 1");
+    REQUIRE(castled < eval.evaluate(board));
+  }
+}
+
+TEST_CASE("incremental score matches a full recompute") {
+  Board board;
+  MoveGenerator move_gen;
+  board.initialize_fen(
+      "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1");
+
+  // every move, played and taken back, in every position one ply deep
+  MoveList moves = move_gen.generate_legal_moves(board, WHITE);
+  for (size_t i = 0; i < moves.size(); i++) {
+    board.execute_move(moves[i]);
+    REQUIRE(board.get_psq_score() == board.generate_psq_score());
+    REQUIRE(board.get_phase() == board.generate_phase());
+    REQUIRE(board.get_pawn_zkey() == board.generate_pawn_zkey());
+    MoveList replies = move_gen.generate_legal_moves(board, BLACK);
+    for (size_t j = 0; j < replies.size(); j++) {
+      board.execute_move(replies[j]);
+      REQUIRE(board.get_psq_score() == board.generate_psq_score());
+      REQUIRE(board.get_phase() == board.generate_phase());
+      REQUIRE(board.get_pawn_zkey() == board.generate_pawn_zkey());
+      board.undo_move(replies[j]);
+    }
+    board.undo_move(moves[i]);
+  }
+  REQUIRE(board.get_psq_score() == board.generate_psq_score());
+  REQUIRE(board.get_phase() == board.generate_phase());
+  REQUIRE(board.get_pawn_zkey() == board.generate_pawn_zkey());
+}
+
+TEST_CASE("pawn structure") {
+  Evaluation eval;
+  Board board;
+  bitboard passed_pawns[2];
+
+  SECTION("passed pawns") {
+    board.initialize_fen("4k3/8/8/3P4/8/8/2p5/4K3 w - - 0 1");
+    PawnEntry &entry = eval.probe_pawn_table(board);
+    REQUIRE(entry.pawn_zkey == board.get_pawn_zkey());
+    REQUIRE(entry.passed_pawns[WHITE] == position_string_to_bitboard("d5"));
+    REQUIRE(entry.passed_pawns[BLACK] == position_string_to_bitboard("c2"));
+
+    board.initialize_fen("4k3/8/4p3/3P4/8/8/2p5/4K3 w - - 0 1");
+    PawnEntry &blocked_entry = eval.probe_pawn_table(board);
+    REQUIRE(blocked_entry.passed_pawns[WHITE] == 0);
+    REQUIRE(blocked_entry.passed_pawns[BLACK] ==
+            position_string_to_bitboard("c2"));
+  }
+
+  SECTION("doubled and isolated pawns") {
+    board.initialize_fen("4k3/8/8/8/8/3P4/3P4/4K3 w - - 0 1");
+    int doubled_isolated = Evaluation::evaluate_pawns(board, passed_pawns);
+    REQUIRE(passed_pawns[WHITE] == position_string_to_bitboard("d3"));
+    board.initialize_fen("4k3/8/8/8/8/8/3PP3/4K3 w - - 0 1");
+    int connected = Evaluation::evaluate_pawns(board, passed_pawns);
+    REQUIRE(Evaluation::get_mg_score(doubled_isolated) <
+            Evaluation::get_mg_score(connected));
+    REQUIRE(Evaluation::get_eg_score(doubled_isolated) <
+            Evaluation::get_eg_score(connected));
+  }
+
+  SECTION("backward pawn") {
+    board.initialize_fen("4k3/8/8/4p3/2P5/3P4/8/4K3 w - - 0 1");
+    int guarded = Evaluation::evaluate_pawns(board, passed_pawns);
+    board.initialize_fen("4k3/8/4p3/8/2P5/3P4/8/4K3 w - - 0 1");
+    int unguarded = Evaluation::evaluate_pawns(board, passed_pawns);
+    REQUIRE(guarded - unguarded == Evaluation::backward_pawn_score);
+  }
+
+  SECTION("pawn shelter") {
+    board.initialize_fen("4k3/8/8/8/8/8/5PPP/6K1 w - - 0 1");
+    REQUIRE(Evaluation::evaluate_shelter(board, WHITE) ==
+            3 * Evaluation::shelter_pawn_scores[0]);
+    board.initialize_fen("4k3/8/8/8/6P1/8/5P1P/6K1 w - - 0 1");
+    REQUIRE(Evaluation::evaluate_shelter(board, WHITE) ==
+            2 * Evaluation::shelter_pawn_scores[0] +
+                Evaluation::shelter_pawn_scores[2]);
+    REQUIRE(Evaluation::evaluate_shelter(board, BLACK) ==
+            3 * Evaluation::shelter_pawn_scores[2]);
+  }
+
+  SECTION("table hits once a structure is stored") {
+    board.initialize_board_starting_position();
+    PawnEntry &entry = eval.probe_pawn_table(board);
+    REQUIRE(entry.pawn_zkey == board.get_pawn_zkey());
+    entry.score = 12345; // a hit returns the entry without evaluating again
+    REQUIRE(eval.probe_pawn_table(board).score == 12345);
   }
 }
 
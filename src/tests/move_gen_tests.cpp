@@ -5,6 +5,7 @@
 #include <catch2/catch_test_macros.hpp>
 
 #include "../MoveGenerator.hpp"
+#include "../MovePicker.hpp"
 
 bool move_vec_contains(MoveList &moves, Move &move);
 void print_move_vec(MoveList &moves);
@@ -190,6 +191,110 @@ TEST_CASE("knight move gen") {
   }
 }
 
+TEST_CASE("captures and quiets generation modes partition legal moves") {
+  Board board;
+  MoveGenerator move_gen;
+
+  SECTION("perft position 2") { board.initialize_perft_position_2(); }
+
+  SECTION("perft position 4") {
+    board.initialize_fen(
+        "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1");
+  }
+
+  SECTION("promotions") {
+    board.initialize_fen("n1n5/PPPk4/8/8/8/8/4Kppp/5N1N b - - 0 1");
+  }
+
+  Color color = board.get_turn_color();
+  MoveList all_moves = move_gen.generate_legal_moves(board, color);
+  MoveList captures = move_gen.generate_legal_moves(
+      board, color, GenerationMode::Value::CAPTURES);
+  MoveList quiets = move_gen.generate_legal_moves(
+      board, color, GenerationMode::Value::QUIETS);
+
+  REQUIRE(captures.size() + quiets.size() == all_moves.size());
+  for (int i = 0; i < captures.size(); i++) {
+    REQUIRE(move_vec_contains(all_moves, captures[i]));
+    REQUIRE((captures[i].is_capture() || captures[i].get_flags() == 11));
+  }
+  for (int i = 0; i < quiets.size(); i++) {
+    REQUIRE(move_vec_contains(all_moves, quiets[i]));
+    REQUIRE(!move_vec_contains(captures, quiets[i]));
+  }
+}
+
+TEST_CASE("evasions generation mode") {
+  Board board;
+  MoveGenerator move_gen;
+  board.initialize_fen(
+      "rnb1kbnr/pppp1ppp/8/4p3/6Pq/5P2/PPPPP2P/RNBQKBNR w KQkq - 1 3");
+
+  MoveList evasions = move_gen.generate_legal_moves(
+      board, WHITE, GenerationMode::Value::EVASIONS);
+  REQUIRE(evasions.size() == 0); // fool's mate
+
+  board.initialize_fen("4k3/8/8/8/8/8/3q4/R3K3 w Q - 0 1");
+  evasions = move_gen.generate_legal_moves(board, WHITE,
+                                           GenerationMode::Value::EVASIONS);
+  REQUIRE(evasions.size() == 2); // Kxd2, Kf1 (no castling out of check)
+}
+
+TEST_CASE("move picker returns every legal move once") {
+  Board board;
+  MoveGenerator move_gen;
+
+  SECTION("perft position 2") { board.initialize_perft_position_2(); }
+
+  SECTION("perft position 4") {
+    board.initialize_fen(
+        "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1");
+  }
+
+  SECTION("in check") {
+    board.initialize_fen(
+        "rnb1kbnr/pppp1ppp/8/4p3/6Pq/5P2/PPPPP2P/RNBQKBNR w KQkq - 1 3");
+  }
+
+  MoveList legal_moves =
+      move_gen.generate_legal_moves(board, board.get_turn_color());
+  Move tt_move = legal_moves[legal_moves.size() - 1];
+  Move killer = legal_moves[0];
+  Move illegal_move('a', 3, 'a', 4, 0);
+  MovePicker move_picker(board, move_gen, tt_move, killer, illegal_move);
+
+  MoveList picked_moves;
+  for (Move move = move_picker.next_move(); !move.is_null();
+       move = move_picker.next_move()) {
+    REQUIRE(!move_vec_contains(picked_moves, move));
+    REQUIRE(move_vec_contains(legal_moves, move));
+    picked_moves.add_move(move);
+  }
+  REQUIRE(picked_moves.size() == legal_moves.size());
+  REQUIRE(picked_moves[0].move_equals(tt_move));
+}
+
+TEST_CASE("move picker orders captures by mvv-lva") {
+  Board board;
+  MoveGenerator move_gen;
+  // the d5 pawn can take the queen on e6 or the rook on c6, the queen on d1
+  // can take the pawn on a4
+  board.initialize_fen("7k/8/2r1q3/3P4/p7/8/8/K2Q4 w - - 0 1");
+
+  MovePicker move_picker(board, move_gen, Move(), Move(), Move());
+  Move first = move_picker.next_move();
+  Move second = move_picker.next_move();
+  Move third = move_picker.next_move();
+
+  Move pawn_takes_queen('d', 5, 'e', 6, 4);
+  Move pawn_takes_rook('d', 5, 'c', 6, 4);
+  Move queen_takes_pawn('d', 1, 'a', 4, 4);
+
+  REQUIRE(first.move_equals(pawn_takes_queen));
+  REQUIRE(second.move_equals(pawn_takes_rook));
+  REQUIRE(third.move_equals(queen_takes_pawn));
+}
+
 // Helpers:
 bool move_vec_contains(MoveList &moves, Move &move) {
   for (int i = 0; i < moves.size(); i++) {
@@ -65,6 +65,89 @@ TEST_CASE("perft position 2 results up to depth 4") {
   }
 }
 
+TEST_CASE("perft position 2 legal generation up to depth 4") {
+  Board board;
+  MoveGenerator move_gen;
+
+  board.initialize_perft_position_2();
+
+  SECTION("depth 1") {
+    uint64_t result = move_gen.fast_perft(1, board);
+    REQUIRE(result == 48);
+  }
+
+  SECTION("depth 2") {
+    uint64_t result = move_gen.fast_perft(2, board);
+    REQUIRE(result == 2039);
+  }
+
+  SECTION("depth 3") {
+    uint64_t result = move_gen.fast_perft(3, board);
+    REQUIRE(result == 97862);
+  }
+
+  SECTION("depth 4") {
+    uint64_t result = move_gen.fast_perft(4, board);
+    REQUIRE(result == 4085603);
+  }
+}
+
+TEST_CASE("perft position 4 results up to depth 4") {
+  Board board;
+  MoveGenerator move_gen;
+
+  board.initialize_fen(
+      "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1");
+
+  SECTION("depth 1") {
+    uint64_t result = move_gen.fast_perft(1, board);
+    REQUIRE(result == 6);
+  }
+
+  SECTION("depth 2") {
+    uint64_t result = move_gen.fast_perft(2, board);
+    REQUIRE(result == 264);
+  }
+
+  SECTION("depth 3") {
+    uint64_t result = move_gen.fast_perft(3, board);
+    REQUIRE(result == 9467);
+  }
+
+  SECTION("depth 4") {
+    uint64_t result = move_gen.fast_perft(4, board);
+    REQUIRE(result == 422333);
+  }
+}
+
+TEST_CASE("perft position 5 results up to depth 4") {
+  Board board;
+  MoveGenerator move_gen;
+
+  board.initialize_fen(
+      "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8");
+
+  SECTION("depth 1") {
+    uint64_t result = move_gen.fast_perft(1, board);
+    REQUIRE(result == 44);
+  }
+
+  SECTION("depth 2") {
+    uint64_t result = move_gen.fast_perft(2, board);
+    REQUIRE(result == 1486);
+  }
+
+  SECTION("depth 3") {
+    uint64_t result = move_gen.fast_perft(3, board);
+    REQUIRE(result == 62379);
+  }
+
+  SECTION("depth 4") {
+    uint64_t result = move_gen.fast_perft(4, board);
+    REQUIRE(result == 2103487);
+  }
+}
+
 TEST_CASE("perft startpos up to depth 5") {
   Board board;
   MoveGenerator move_gen;
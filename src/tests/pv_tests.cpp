@@ -0,0 +1,52 @@
+#ifndef PV_TESTS_CPP // GUARD
+#define PV_TESTS_CPP // GUARD
+
+#include "iostream"
+#include <catch2/catch_test_macros.hpp>
+
+#include "../PVTable.hpp"
+
+TEST_CASE("principal variation fills to the deepest ply") {
+  PVTable pv_table;
+  const unsigned max_depth = 64;
+
+  // a line found at every ply, backed up from the deepest one to the root
+  for (unsigned ply = max_depth; ply-- > 0;) {
+    Move move((uint16_t)(ply + 1));
+    pv_table.add_move(ply, move);
+  }
+
+  REQUIRE(pv_table.pv_lengths[0] == max_depth);
+  for (unsigned ply = 0; ply < max_depth; ply++) {
+    REQUIRE(pv_table.pv_table[ply].get_move_rep() == ply + 1);
+  }
+
+  // a new best move at the root is followed by the line of the ply below
+  Move root_move((uint16_t)1000);
+  pv_table.add_move(0, root_move);
+  REQUIRE(pv_table.pv_table[0].get_move_rep() == 1000);
+  for (unsigned ply = 1; ply < max_depth; ply++) {
+    REQUIRE(pv_table.pv_table[ply].get_move_rep() == ply + 1);
+  }
+}
+
+TEST_CASE("principal variation drops the line of a cleared ply") {
+  PVTable pv_table;
+  for (unsigned ply = 4; ply-- > 0;) {
+    Move move((uint16_t)(ply + 1));
+    pv_table.add_move(ply, move);
+  }
+  REQUIRE(pv_table.pv_lengths[0] == 4);
+
+  // the ply below was entered again and found no line this time
+  pv_table.clear_ply(1);
+  Move root_move((uint16_t)1000);
+  pv_table.add_move(0, root_move);
+  REQUIRE(pv_table.pv_lengths[0] == 1);
+  REQUIRE(pv_table.pv_table[0].get_move_rep() == 1000);
+
+  pv_table.clear();
+  REQUIRE(pv_table.pv_lengths[0] == 0);
+}
+
+#endif // GUARD
@@ -0,0 +1,64 @@
+#ifndef SEARCH_TESTS_CPP // GUARD
+#define SEARCH_TESTS_CPP // GUARD
+
+#include "iostream"
+#include <catch2/catch_test_macros.hpp>
+
+#include "../Board.hpp"
+#include "../ThreadPool.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+TEST_CASE("node limited searches are reproducible") {
+  ThreadPool thread_pool;
+  Board board;
+  // after 1. e4 e5 2. Nf3
+  board.initialize_fen(
+      "rnbqkbnr/pppp1ppp/8/4p3/4P3/5N2/PPPP1PPP/RNBQKB1R b KQkq - 1 2");
+  SearchLimits limits;
+  limits.nodes = 20000;
+
+  Move first_move = thread_pool.search(limits, board);
+  uint64_t first_nodes = thread_pool.get_nodes_evaluated();
+
+  Move second_move = thread_pool.search(limits, board);
+  REQUIRE(second_move.move_equals(first_move));
+  REQUIRE(thread_pool.get_nodes_evaluated() == first_nodes);
+
+  // an unrelated search in between leaves nothing behind either
+  Board other_board;
+  other_board.initialize_perft_position_2();
+  SearchLimits depth_limits;
+  depth_limits.depth = 4;
+  thread_pool.search(depth_limits, other_board);
+
+  Move third_move = thread_pool.search(limits, board);
+  REQUIRE(third_move.move_equals(first_move));
+  REQUIRE(thread_pool.get_nodes_evaluated() == first_nodes);
+}
+
+TEST_CASE("ponderhit right after go ponder is not lost") {
+  ThreadPool thread_pool;
+  Board board;
+  board.initialize_board_starting_position();
+  SearchLimits limits;
+  limits.ponder = true;
+  limits.soft_time = 50;
+  limits.hard_time = 100;
+
+  std::atomic<bool> reported(false);
+  thread_pool.start_search(limits, board,
+                           [&reported](Move move) { reported = true; });
+  thread_pool.ponderhit();
+
+  // the clock starts on ponderhit, so the search reports well within this
+  for (int i = 0; i < 5000 && !reported; i++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  REQUIRE(reported);
+  thread_pool.stop();
+}
+
+#endif // GUARD
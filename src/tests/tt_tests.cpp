@@ -0,0 +1,185 @@
+#ifndef TT_TESTS_CPP // GUARD
+#define TT_TESTS_CPP // GUARD
+
+#include "iostream"
+#include <catch2/catch_test_macros.hpp>
+
+#include "../MoveGenerator.hpp"
+#include "../TTable.hpp"
+
+#include <atomic>
+#include <random>
+#include <set>
+#include <thread>
+#include <vector>
+
+struct StressPosition {
+  Board board;
+  uint64_t zkey;
+  Move move;
+  uint8_t depth;
+  int score;
+};
+
+std::vector<StressPosition> get_stress_positions();
+
+TEST_CASE("entries pack and unpack") {
+  Move move('e', 2, 'e', 4, 1);
+  TTEntry entry(TTEntryType::Value::LOWER, move, 17, -31999, 63);
+
+  Move best_move = entry.get_best_move();
+  REQUIRE(best_move.move_equals(move));
+  REQUIRE(entry.get_type() == TTEntryType::Value::LOWER);
+  REQUIRE(entry.get_depth() == 17);
+  REQUIRE(entry.get_score() == -31999);
+  REQUIRE(entry.get_generation() == 63);
+}
+
+TEST_CASE("probe returns what was stored") {
+  TTable t_table(1);
+  Move move('g', 1, 'f', 3, 0);
+  t_table.set_entry(0x123456789abcdef0, 5, TTEntryType::Value::EXACT, move,
+                    42);
+
+  TTEntry entry = t_table.probe_entry(0x123456789abcdef0, 5);
+  Move best_move = entry.get_best_move();
+  REQUIRE(entry.get_type() == TTEntryType::Value::EXACT);
+  REQUIRE(best_move.move_equals(move));
+  REQUIRE(entry.get_score() == 42);
+
+  REQUIRE(t_table.probe_entry(0x123456789abcdef0, 6).get_type() ==
+          TTEntryType::Value::NONE);
+  REQUIRE(t_table.probe_entry(0x123456789abcdef1, 0).get_type() ==
+          TTEntryType::Value::NONE);
+}
+
+TEST_CASE("resize reports the size allocated") {
+  TTable t_table(1);
+  Move move('g', 1, 'f', 3, 0);
+  t_table.set_entry(0x123456789abcdef0, 5, TTEntryType::Value::EXACT, move,
+                    42);
+
+  REQUIRE(t_table.resize(2) == 2);
+  REQUIRE(t_table.get_size() == (2 << 20) / 64);
+  REQUIRE(t_table.probe_entry(0x123456789abcdef0, 0).get_type() ==
+          TTEntryType::Value::NONE);
+}
+
+TEST_CASE("shallow stores keep a deeper entry for the same key") {
+  TTable t_table(1);
+  uint64_t zkey = 0x123456789abcdef0;
+  Move move('g', 1, 'f', 3, 0);
+  t_table.set_entry(zkey, 8, TTEntryType::Value::LOWER, move, 42);
+
+  t_table.set_entry(zkey, 0, TTEntryType::Value::UPPER, Move(), -7);
+  TTEntry entry = t_table.probe_entry(zkey, 0);
+  REQUIRE(entry.get_depth() == 8);
+  REQUIRE(entry.get_score() == 42);
+
+  // within the margin
+  t_table.set_entry(zkey, 5, TTEntryType::Value::UPPER, Move(), -7);
+  entry = t_table.probe_entry(zkey, 0);
+  REQUIRE(entry.get_depth() == 5);
+  REQUIRE(entry.get_best_move().move_equals(move));
+
+  t_table.set_entry(zkey, 0, TTEntryType::Value::EXACT, Move(), 13);
+  entry = t_table.probe_entry(zkey, 0);
+  REQUIRE(entry.get_depth() == 0);
+  REQUIRE(entry.get_score() == 13);
+
+  // an entry from an earlier search is always replaced
+  t_table.set_entry(zkey, 8, TTEntryType::Value::LOWER, move, 42);
+  t_table.new_search();
+  t_table.set_entry(zkey, 0, TTEntryType::Value::UPPER, Move(), -7);
+  entry = t_table.probe_entry(zkey, 0);
+  REQUIRE(entry.get_depth() == 0);
+  REQUIRE(entry.get_score() == -7);
+  REQUIRE(entry.get_best_move().move_equals(move));
+}
+
+TEST_CASE("concurrent probes and stores never return another position's "
+          "entry") {
+  std::vector<StressPosition> positions = get_stress_positions();
+  TTable t_table(1);
+  // crowd every position into a few clusters so that threads keep
+  // overwriting each other's entries
+  t_table.index_mask = 3;
+
+  std::atomic<unsigned> hits(0);
+  std::atomic<unsigned> mismatches(0);
+  std::vector<std::thread> threads;
+  for (unsigned thread_id = 0; thread_id < 8; thread_id++) {
+    threads.push_back(std::thread([&, thread_id]() {
+      std::vector<StressPosition> local_positions = positions;
+      MoveGenerator move_gen;
+      std::mt19937 rng(thread_id);
+      for (unsigned i = 0; i < 200000; i++) {
+        StressPosition &position =
+            local_positions[rng() % local_positions.size()];
+        if (rng() & 1) {
+          t_table.set_entry(position.zkey, position.depth,
+                            TTEntryType::Value::EXACT, position.move,
+                            position.score);
+          continue;
+        }
+
+        TTEntry entry = t_table.probe_entry(position.zkey, 0);
+        if (entry.get_type() == TTEntryType::Value::NONE) {
+          continue;
+        }
+        ++hits;
+        Move move = entry.get_best_move();
+        Color color = position.board.get_turn_color();
+        bool is_legal =
+            move_gen.is_pseudo_legal(position.board, color, move) &&
+            move_gen.is_legal(position.board, color, move,
+                              position.board.get_checkers(color),
+                              position.board.get_pinned_pieces(color));
+        if (!is_legal || !move.move_equals(position.move) ||
+            entry.get_depth() != position.depth ||
+            entry.get_score() != position.score) {
+          ++mismatches;
+        }
+      }
+    }));
+  }
+  for (size_t i = 0; i < threads.size(); i++) {
+    threads[i].join();
+  }
+
+  REQUIRE(hits > 0);
+  REQUIRE(mismatches == 0);
+}
+
+// Helpers:
+// Distinct positions from random games, each with one of its legal moves.
+std::vector<StressPosition> get_stress_positions() {
+  std::vector<StressPosition> positions;
+  std::set<uint64_t> zkeys;
+  MoveGenerator move_gen;
+  std::mt19937 rng(1);
+  for (unsigned game = 0; game < 20; game++) {
+    Board board;
+    board.initialize_board_starting_position();
+    for (unsigned ply = 0; ply < 40; ply++) {
+      MoveList moves = move_gen.generate_legal_moves(board,
+                                                     board.get_turn_color());
+      if (moves.size() == 0) {
+        break;
+      }
+      Move move = moves[rng() % moves.size()];
+      if (!zkeys.insert(board.get_zkey()).second) {
+        board.execute_move(move);
+        continue;
+      }
+      StressPosition position = {board, board.get_zkey(), move,
+                                 (uint8_t)(rng() % 64),
+                                 (int)(rng() % 60000) - 30000};
+      positions.push_back(position);
+      board.execute_move(move);
+    }
+  }
+  return positions;
+}
+
+#endif // GUARD